@@ -25,55 +25,189 @@ All use of these programs is entirely at the user's own risk.
 
 #include "src/nqs_paper.hh"
 
-int main(int argc, char *argv[]){
+//Defining and running the sampler, with one or more Markov chains
+//Wf is the wave-function type and Rng is the random number policy
+template<class Wf,class Hamiltonian,class Rng> void RunChains(Wf & wavef,Hamiltonian & hamiltonian,std::map<std::string,std::string> & opts){
 
-  auto opts=ReadOptions(argc,argv);
+  int nsweeps=std::stod(opts["nsweeps"]);
 
-  //Definining the neural-network wave-function
-  Nqs wavef(opts["filename"]);
+  bool printastes=opts.count("filestates");
+  bool binarystates=(opts["statesformat"]=="binary");
 
-  int nsweeps=std::stod(opts["nsweeps"]);
-  int nspins=wavef.Nspins();
+  int seed=std::stoi(opts["seed"]);
 
-  //Problem hamiltonian inferred from file name
-  std::string model=opts["model"];
+  int nchains=std::stoi(opts["nchains"]);
+  int nthreads=std::stoi(opts["threads"]);
+
+  double targeterror=std::stod(opts["targeterror"]);
+
+  bool batched=(opts["proposals"]=="batched");
+  double localratio=std::stod(opts["localmoves"]);
+
+  if(nchains==1){
+    Sampler<Wf,Hamiltonian,Rng> sampler(wavef,hamiltonian,seed);
+    if(printastes){
+      sampler.SetFileStates(opts["filestates"],binarystates);
+    }
+    if(opts.count("fileenergies")){
+      sampler.SetFileEnergies(opts["fileenergies"]);
+    }
+    sampler.SetTargetError(targeterror);
+    sampler.SetBatchedProposals(batched);
+    sampler.SetLocalMoves(localratio);
+    if(opts.count("checkpoint")){
+      sampler.SetCheckpoint(opts["checkpoint"],std::stod(opts["checkpointinterval"]));
+    }
+    if(opts.count("warmstart")){
+      sampler.SetWarmStart(opts["warmstart"]);
+    }
+    if(opts.count("profile")){
+      sampler.SetFileProfile(opts["profile"]);
+    }
+    sampler.Run(nsweeps);
+  }
+  else{
+    ParallelSampler<Wf,Hamiltonian,Rng> sampler(wavef,hamiltonian,seed,nchains,nthreads);
+    if(printastes){
+      sampler.SetFileStates(opts["filestates"],binarystates);
+    }
+    if(opts.count("fileenergies")){
+      sampler.SetFileEnergies(opts["fileenergies"]);
+    }
+    sampler.SetTargetError(targeterror);
+    sampler.SetBatchedProposals(batched);
+    sampler.SetLocalMoves(localratio);
+    if(opts.count("checkpoint")){
+      sampler.SetCheckpoint(opts["checkpoint"],std::stod(opts["checkpointinterval"]));
+    }
+    if(opts.count("warmstart")){
+      sampler.SetWarmStart(opts["warmstart"]);
+    }
+    if(opts.count("profile")){
+      sampler.SetFileProfile(opts["profile"]);
+    }
+    sampler.Run(nsweeps);
+  }
+}
+
+//Sampling several wave-functions together, with replica swaps
+template<class Wf,class Hamiltonian,class Rng> void RunReplicas(Wf & wavef,Hamiltonian & hamiltonian,std::map<std::string,std::string> & opts){
+
+  int nsweeps=std::stod(opts["nsweeps"]);
 
   bool printastes=opts.count("filestates");
+  bool binarystates=(opts["statesformat"]=="binary");
 
   int seed=std::stoi(opts["seed"]);
+  int nthreads=std::stoi(opts["threads"]);
+
+  bool batched=(opts["proposals"]=="batched");
+  double localratio=std::stod(opts["localmoves"]);
+
+  //the first replica is the wave-function already loaded
+  std::vector<std::string> names=SplitList(opts["replicas"]);
+  std::vector<Wf> wfs(1,wavef);
+  for(std::size_t r=1;r<names.size();r++){
+    wfs.push_back(Wf(names[r]));
+  }
+
+  ReplicaSampler<Wf,Hamiltonian,Rng> sampler(wfs,names,hamiltonian,seed,nthreads);
+  if(printastes){
+    sampler.SetFileStates(opts["filestates"],binarystates);
+  }
+  if(opts.count("fileenergies")){
+    sampler.SetFileEnergies(opts["fileenergies"]);
+  }
+  sampler.SetSwapInterval(std::stoi(opts["swapinterval"]));
+  sampler.SetBatchedProposals(batched);
+  sampler.SetLocalMoves(localratio);
+  sampler.Run(nsweeps);
+}
+
+//Choosing between independent chains and replicas
+template<class Wf,class Hamiltonian,class Rng> void RunSampler(Wf & wavef,Hamiltonian & hamiltonian,std::map<std::string,std::string> & opts){
+  if(opts.count("replicas")){
+    RunReplicas<Wf,Hamiltonian,Rng>(wavef,hamiltonian,opts);
+  }
+  else{
+    RunChains<Wf,Hamiltonian,Rng>(wavef,hamiltonian,opts);
+  }
+}
+
+//Computing the exact energy by full enumeration
+template<class Wf,class Hamiltonian> void RunExact(Wf & wavef,Hamiltonian & hamiltonian,std::map<std::string,std::string> & opts){
+  int nthreads=std::stoi(opts["threads"]);
+  bool sz0=(opts["exact"]=="sz0");
+
+  ExactEngine<Wf,Hamiltonian> engine(wavef,hamiltonian,nthreads,sz0);
+  engine.Run();
+}
+
+//Choosing the random number policy, or the exact enumeration
+template<class Wf,class Hamiltonian> void RunSampler(Wf & wavef,Hamiltonian & hamiltonian,std::map<std::string,std::string> & opts){
+  if(opts.count("exact")){
+    RunExact(wavef,hamiltonian,opts);
+  }
+  else if(opts["rng"]=="xoshiro"){
+    RunSampler<Wf,Hamiltonian,XoshiroRng>(wavef,hamiltonian,opts);
+  }
+  else{
+    RunSampler<Wf,Hamiltonian,StdRng>(wavef,hamiltonian,opts);
+  }
+}
+
+//Sampling many files in a single run
+template<class Rng> void RunBatch(std::map<std::string,std::string> & opts){
+  BatchRunner<Rng> runner(BatchFiles(opts["batch"]),std::stoi(opts["seed"]),
+    std::stoi(opts["nseeds"]),std::stoi(opts["threads"]));
+
+  runner.SetSweeps(std::stod(opts["nsweeps"]));
+  runner.SetBatchedProposals(opts["proposals"]=="batched");
+  runner.SetLocalMoves(std::stod(opts["localmoves"]));
+  runner.SetTargetError(std::stod(opts["targeterror"]));
+
+  if(opts.count("results")){
+    std::ofstream fout(opts["results"].c_str());
+    if(!fout.is_open()){
+      std::cerr<<"# Error : Cannot open file "<<opts["results"]<<" for writing"<<std::endl;
+      std::abort();
+    }
+    runner.Run(fout);
+    std::cout<<"# Results written to file "<<opts["results"]<<std::endl;
+  }
+  else{
+    runner.Run(std::cout);
+  }
+}
+
+//Loading the wave-function, in the given precision, and choosing the model
+template<class Wf> void RunModel(std::map<std::string,std::string> & opts){
+
+  //Definining the neural-network wave-function
+  Wf wavef(opts["filename"]);
+
+  int nspins=wavef.Nspins();
+
+  //Problem hamiltonian inferred from file name
+  std::string model=opts["model"];
 
   if(model=="Ising1d"){
     double hfield=std::stod(opts["hfield"]);
     Ising1d hamiltonian(nspins,hfield);
 
-    //Defining and running the sampler
-    Sampler<Nqs,Ising1d> sampler(wavef,hamiltonian,seed);
-    if(printastes){
-      sampler.SetFileStates(opts["filestates"]);
-    }
-    sampler.Run(nsweeps);
+    RunSampler(wavef,hamiltonian,opts);
   }
   else if(model=="Heisenberg1d"){
     double jz=std::stod(opts["jz"]);
     Heisenberg1d hamiltonian(nspins,jz);
 
-    //Defining and running the sampler
-    Sampler<Nqs,Heisenberg1d> sampler(wavef,hamiltonian,seed);
-    if(printastes){
-      sampler.SetFileStates(opts["filestates"]);
-    }
-    sampler.Run(nsweeps);
+    RunSampler(wavef,hamiltonian,opts);
   }
   else if(model=="Heisenberg2d"){
     double jz=std::stod(opts["jz"]);
     Heisenberg2d hamiltonian(nspins,jz);
 
-    //Defining and running the sampler
-    Sampler<Nqs,Heisenberg2d> sampler(wavef,hamiltonian,seed);
-    if(printastes){
-      sampler.SetFileStates(opts["filestates"]);
-    }
-    sampler.Run(nsweeps);
+    RunSampler(wavef,hamiltonian,opts);
   }
   else{
     std::cerr<<"#The given input file does not correspond to one of the implemented problem hamiltonians";
@@ -81,3 +215,127 @@ int main(int argc, char *argv[]){
   }
 
 }
+
+//Problem hamiltonians, with the couplings given in the options
+template<class Hamiltonian> Hamiltonian MakeHamiltonian(int nspins,std::map<std::string,std::string> & opts);
+
+template<> Ising1d MakeHamiltonian<Ising1d>(int nspins,std::map<std::string,std::string> & opts){
+  return Ising1d(nspins,std::stod(opts["hfield"]));
+}
+
+template<> Heisenberg1d MakeHamiltonian<Heisenberg1d>(int nspins,std::map<std::string,std::string> & opts){
+  return Heisenberg1d(nspins,std::stod(opts["jz"]));
+}
+
+template<> Heisenberg2d MakeHamiltonian<Heisenberg2d>(int nspins,std::map<std::string,std::string> & opts){
+  return Heisenberg2d(nspins,std::stod(opts["jz"]));
+}
+
+//Monte Carlo sampling with a wave-function of NV visible and NH hidden units
+//fixed at compile time
+template<class Hamiltonian,class T,int NV,int NH> void RunFixedSize(std::map<std::string,std::string> & opts){
+  NqsT<T,NV,NH> wavef(opts["filename"]);
+  Hamiltonian hamiltonian=MakeHamiltonian<Hamiltonian>(NV,opts);
+
+  if(opts["rng"]=="xoshiro"){
+    RunChains<NqsT<T,NV,NH>,Hamiltonian,XoshiroRng>(wavef,hamiltonian,opts);
+  }
+  else{
+    RunChains<NqsT<T,NV,NH>,Hamiltonian,StdRng>(wavef,hamiltonian,opts);
+  }
+}
+
+template<class Hamiltonian,int NV,int NH> void RunFixedSize(std::map<std::string,std::string> & opts){
+  if(opts["precision"]=="mixed"){
+    RunFixedSize<Hamiltonian,float,NV,NH>(opts);
+  }
+  else{
+    RunFixedSize<Hamiltonian,double,NV,NH>(opts);
+  }
+}
+
+//Models and sizes with a specialized sampler, those of the files in Ground/
+//all the other runs, as well as replicas and exact enumerations, use the
+//generic wave-function whose sizes are read from the file
+//the table is compiled only with -DNQS_FIXED_SIZES: the rows of the weights
+//are already padded and vectorized, and the specialized samplers were found
+//to be within 5% of the generic ones, at four times the compilation time
+struct FixedSizeRunner{
+  const char * model;
+  int nv;
+  int nh;
+  void (*run)(std::map<std::string,std::string> &);
+};
+
+#if defined(NQS_FIXED_SIZES)
+const FixedSizeRunner FixedSizeRunners[]={
+  {"Ising1d",40,40,RunFixedSize<Ising1d,40,40>},
+  {"Ising1d",40,80,RunFixedSize<Ising1d,40,80>},
+  {"Ising1d",40,160,RunFixedSize<Ising1d,40,160>},
+  {"Ising1d",80,80,RunFixedSize<Ising1d,80,80>},
+  {"Ising1d",80,160,RunFixedSize<Ising1d,80,160>},
+  {"Ising1d",80,320,RunFixedSize<Ising1d,80,320>},
+  {"Heisenberg1d",40,40,RunFixedSize<Heisenberg1d,40,40>},
+  {"Heisenberg1d",40,80,RunFixedSize<Heisenberg1d,40,80>},
+  {"Heisenberg1d",40,160,RunFixedSize<Heisenberg1d,40,160>},
+  {"Heisenberg1d",80,80,RunFixedSize<Heisenberg1d,80,80>},
+  {"Heisenberg1d",80,160,RunFixedSize<Heisenberg1d,80,160>},
+  {"Heisenberg1d",80,320,RunFixedSize<Heisenberg1d,80,320>},
+  {"Heisenberg2d",100,100,RunFixedSize<Heisenberg2d,100,100>},
+  {"Heisenberg2d",100,200,RunFixedSize<Heisenberg2d,100,200>},
+  {"Heisenberg2d",100,400,RunFixedSize<Heisenberg2d,100,400>},
+  {"Heisenberg2d",100,800,RunFixedSize<Heisenberg2d,100,800>},
+  {"Heisenberg2d",100,3200,RunFixedSize<Heisenberg2d,100,3200>},
+};
+#endif
+
+//Runs the specialized sampler matching the options, if there is one
+bool RunFixedSize(std::map<std::string,std::string> & opts){
+#if defined(NQS_FIXED_SIZES)
+  if(opts.count("replicas") || opts.count("exact")){
+    return false;
+  }
+
+  int nv,nh;
+  if(!NqsSizes(opts["filename"],nv,nh)){
+    return false;
+  }
+
+  for(const auto & runner : FixedSizeRunners){
+    if(opts["model"]==runner.model && nv==runner.nv && nh==runner.nh){
+      runner.run(opts);
+      return true;
+    }
+  }
+#else
+  (void)opts;
+#endif
+  return false;
+}
+
+int main(int argc, char *argv[]){
+
+  auto opts=ReadOptions(argc,argv);
+
+  if(opts.count("batch")){
+    if(opts["rng"]=="xoshiro"){
+      RunBatch<XoshiroRng>(opts);
+    }
+    else{
+      RunBatch<StdRng>(opts);
+    }
+    return 0;
+  }
+
+  if(RunFixedSize(opts)){
+    return 0;
+  }
+
+  if(opts["precision"]=="mixed"){
+    RunModel<NqsMixed>(opts);
+  }
+  else{
+    RunModel<Nqs>(opts);
+  }
+
+}
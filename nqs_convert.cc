@@ -0,0 +1,65 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include "src/nqs_paper.hh"
+
+//Converts text wave-function files (as found in Ground/ and Unitary/)
+//to the binary format described in src/wfbinary.cc
+//Each file FILENAME.wf is converted to FILENAME.wfb, in the same directory
+//Files already in binary format are checked against their checksum, which
+//is not verified when they are loaded by nqs_run
+
+int main(int argc, char *argv[]){
+
+  if(argc==1){
+    std::cout<<"Usage : ./nqs_convert FILENAME [FILENAME ...]"<<std::endl<<std::endl;
+    std::cout<<"Converts the given text wave-function files to the binary format."<<std::endl;
+    std::cout<<"The output for FILENAME.wf is written to FILENAME.wfb"<<std::endl;
+    std::cout<<"Binary files given as FILENAME are checked for corruption."<<std::endl;
+    std::exit(0);
+  }
+
+  for(int i=1;i<argc;i++){
+    std::string filename=argv[i];
+
+    if(IsWfBinary(filename)){
+      WfBinaryVerify(filename);
+      std::cout<<"# Skipping "<<filename<<" : already in binary format, checksum verified"<<std::endl;
+      continue;
+    }
+
+    Nqs wavef(filename);
+
+    std::string output=filename+"b";
+    if(filename.size()<3 || filename.substr(filename.size()-3)!=".wf"){
+      output=filename+".wfb";
+    }
+
+    wavef.SaveBinaryParameters(output);
+    WfBinaryVerify(output);
+    std::cout<<"# Binary parameters written to file "<<output<<std::endl;
+  }
+
+}
@@ -0,0 +1,95 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include "src/nqs_paper.hh"
+
+//Reads a file of sampled configurations written by nqs_run
+//(in either text or binary format) and prints the configurations
+//in text format, one per row, on standard output
+//If a wave-function file is given, the logarithm of the wave-function
+//(real and imaginary part) is appended to each row
+
+int main(int argc, char *argv[]){
+
+  if(argc!=2 && argc!=3){
+    std::cout<<"Usage : ./nqs_states FILESTATES [FILENAME]"<<std::endl<<std::endl;
+    std::cout<<"Prints the configurations contained in FILESTATES, as written"<<std::endl;
+    std::cout<<"by './nqs_run --filestates=FILESTATES --statesformat=binary',"<<std::endl;
+    std::cout<<"in text format on standard output."<<std::endl;
+    std::cout<<"If the wave-function file FILENAME is given, the logarithm of the"<<std::endl;
+    std::cout<<"wave-function on each configuration is also printed."<<std::endl;
+    std::exit(0);
+  }
+
+  StatesReader reader(argv[1]);
+
+  std::unique_ptr<Nqs> wavef;
+  std::unique_ptr<LogValEvaluator<Nqs> > evaluator;
+
+  if(argc==3){
+    //only configurations and logarithms are printed on standard output
+    wavef.reset(new Nqs(argv[2],false));
+    if(wavef->Nspins()!=reader.Nspins()){
+      std::cerr<<"# Error : The wave-function and the configurations have a different number of spins"<<std::endl;
+      std::abort();
+    }
+    evaluator.reset(new LogValEvaluator<Nqs>(*wavef));
+    std::cout<<std::setprecision(17);
+  }
+
+  //configurations are processed in batches
+  const std::size_t batchsize=4096;
+  std::vector<SpinConfig> batch;
+  std::vector<std::complex<double> > logvals;
+
+  SpinConfig config;
+  std::string row(3*reader.Nspins(),' ');
+
+  bool more=true;
+  while(more){
+    batch.clear();
+    while(batch.size()<batchsize && (more=reader.Read(config))){
+      batch.push_back(config);
+    }
+
+    if(evaluator){
+      evaluator->LogVals(batch,logvals);
+    }
+
+    for(std::size_t b=0;b<batch.size();b++){
+      for(int i=0;i<reader.Nspins();i++){
+        row[3*i]=(batch[b].Spin(i)>0)?' ':'-';
+        row[3*i+1]='1';
+        row[3*i+2]=' ';
+      }
+      std::cout<<row;
+      if(evaluator){
+        std::cout<<logvals[b].real()<<" "<<logvals[b].imag();
+      }
+      std::cout<<'\n';
+    }
+  }
+
+}
@@ -0,0 +1,71 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+//Minimal allocator returning memory aligned to a given boundary (in bytes)
+//It is used to store the network parameters and the look-up tables
+//in buffers suitable for aligned SIMD loads
+template<class T,std::size_t Alignment=64> class AlignedAllocator{
+
+public:
+
+  typedef T value_type;
+
+  template<class U> struct rebind{
+    typedef AlignedAllocator<U,Alignment> other;
+  };
+
+  AlignedAllocator(){}
+
+  template<class U> AlignedAllocator(const AlignedAllocator<U,Alignment> &){}
+
+  T * allocate(std::size_t n){
+    void * p=nullptr;
+    if(posix_memalign(&p,Alignment,n*sizeof(T))!=0){
+      throw std::bad_alloc();
+    }
+    return static_cast<T*>(p);
+  }
+
+  void deallocate(T * p,std::size_t){
+    std::free(p);
+  }
+
+  template<class U> bool operator==(const AlignedAllocator<U,Alignment> &)const{
+    return true;
+  }
+
+  template<class U> bool operator!=(const AlignedAllocator<U,Alignment> &)const{
+    return false;
+  }
+
+};
+
+//Vector with storage aligned to a cache line
+template<class T> using AlignedVector=std::vector<T,AlignedAllocator<T> >;
@@ -0,0 +1,261 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <ctime>
+#include <glob.h>
+
+//Expands the argument of --batch into a list of wave-function files:
+//either a glob pattern (e.g. 'Ground/Ising1d_*.wf') or, if it starts
+//with '@', the name of a file containing one filename per row
+std::vector<std::string> BatchFiles(const std::string & pattern){
+  std::vector<std::string> files;
+
+  if(pattern.size()>0 && pattern[0]=='@'){
+    std::ifstream fin(pattern.substr(1).c_str());
+    if(!fin.good()){
+      std::cerr<<"# Error : Cannot open the list of files "<<pattern.substr(1)<<std::endl;
+      std::abort();
+    }
+    std::string name;
+    while(fin>>name){
+      files.push_back(name);
+    }
+  }
+  else{
+    glob_t g;
+    if(glob(pattern.c_str(),0,nullptr,&g)==0){
+      for(std::size_t i=0;i<g.gl_pathc;i++){
+        files.push_back(g.gl_pathv[i]);
+      }
+    }
+    globfree(&g);
+  }
+
+  if(files.size()==0){
+    std::cerr<<"# Error : No files found for the batch "<<pattern<<std::endl;
+    std::abort();
+  }
+
+  return files;
+}
+
+//Runs the Monte Carlo sampling of many wave-function files in one process
+//Every (file, seed) pair is a job, with a single Markov chain; jobs are
+//taken from a shared queue by a pool of threads
+//Each file is loaded once, and its parameters are shared (not copied) by
+//all the jobs using it; hamiltonians are built once per model, coupling
+//and number of spins, and shared by all the jobs with the same lattice
+//The results are collected in a single table, ordered as the jobs
+template<class Rng=StdRng> class BatchRunner{
+
+  //result of a job
+  struct Result{
+    double energy;
+    double error;
+    double tau;
+    double nmeas;
+    bool converged;
+    double seconds;
+  };
+
+  //loaded wave-functions and their models
+  std::vector<std::string> files_;
+  std::vector<std::unique_ptr<Nqs> > wfs_;
+  std::vector<std::string> models_;
+  std::vector<double> couplings_;
+
+  //hamiltonians, shared among the files with the same lattice
+  std::map<std::string,std::shared_ptr<Ising1d> > ising1d_;
+  std::map<std::string,std::shared_ptr<Heisenberg1d> > heisenberg1d_;
+  std::map<std::string,std::shared_ptr<Heisenberg2d> > heisenberg2d_;
+
+  //jobs, as pairs of file index and seed
+  std::vector<std::pair<int,int> > jobs_;
+  std::vector<Result> results_;
+
+  //number of threads
+  const int nthreads_;
+
+  //options of the samplers
+  double nsweeps_;
+  bool batched_;
+  double localratio_;
+  double targeterror_;
+
+public:
+
+  BatchRunner(const std::vector<std::string> & files,int seed,int nseeds,int nthreads):
+    files_(files),nthreads_(nthreads),nsweeps_(1.0e4),batched_(true),localratio_(0),targeterror_(0){
+
+    if(nseeds<1 || nthreads_<1){
+      std::cerr<<"# Error : The number of seeds and threads should be positive integers"<<std::endl;
+      std::abort();
+    }
+
+    for(const auto & file : files_){
+      const std::string model=FindModel(file);
+      if(model=="None"){
+        std::cerr<<"# Error : The file "<<file<<" does not correspond to one of the implemented problem hamiltonians"<<std::endl;
+        std::abort();
+      }
+      models_.push_back(model);
+      couplings_.push_back(std::stod(FindCoupling(file)));
+      wfs_.push_back(std::unique_ptr<Nqs>(new Nqs(file)));
+
+      const int nspins=wfs_.back()->Nspins();
+      const std::string key=std::to_string(nspins)+"_"+std::to_string(couplings_.back());
+      if(model=="Ising1d" && ising1d_.count(key)==0){
+        ising1d_[key]=std::make_shared<Ising1d>(nspins,couplings_.back());
+      }
+      else if(model=="Heisenberg1d" && heisenberg1d_.count(key)==0){
+        heisenberg1d_[key]=std::make_shared<Heisenberg1d>(nspins,couplings_.back());
+      }
+      else if(model=="Heisenberg2d" && heisenberg2d_.count(key)==0){
+        heisenberg2d_[key]=std::make_shared<Heisenberg2d>(nspins,couplings_.back());
+      }
+    }
+
+    const int baseseed=(seed<0)?int(std::time(nullptr)):seed;
+    for(std::size_t f=0;f<files_.size();f++){
+      for(int s=0;s<nseeds;s++){
+        jobs_.push_back(std::make_pair(int(f),baseseed+s));
+      }
+    }
+  }
+
+  void SetSweeps(double nsweeps){
+    nsweeps_=nsweeps;
+  }
+
+  void SetBatchedProposals(bool batched){
+    batched_=batched;
+  }
+
+  void SetLocalMoves(double localratio){
+    localratio_=localratio;
+  }
+
+  void SetTargetError(double targeterror){
+    targeterror_=targeterror;
+  }
+
+  //runs all the jobs and writes the table of results on the given stream
+  void Run(std::ostream & out){
+    std::cout<<"# Starting batch of "<<jobs_.size()<<" jobs ("<<files_.size()<<" files) on ";
+    std::cout<<nthreads_<<" threads"<<std::endl;
+    std::cout<<"# Sampling... ";
+    std::flush(std::cout);
+
+    results_.resize(jobs_.size());
+    std::atomic<int> next(0);
+
+    std::vector<std::thread> threads;
+    for(int t=0;t<nthreads_;t++){
+      threads.push_back(std::thread([this,&next](){
+        for(int j=next++;j<int(jobs_.size());j=next++){
+          RunJob(j);
+        }
+      }));
+    }
+
+    for(auto & thread : threads){
+      thread.join();
+    }
+
+    std::cout<<" DONE "<<std::endl;
+
+    OutputTable(out);
+  }
+
+  void OutputTable(std::ostream & out)const{
+    out<<"# file model nspins coupling seed measurements energy_per_spin error tau converged seconds"<<std::endl;
+    for(std::size_t j=0;j<jobs_.size();j++){
+      const int f=jobs_[j].first;
+      const Result & r=results_[j];
+      out<<files_[f]<<" "<<models_[f]<<" "<<wfs_[f]->Nspins()<<" "<<couplings_[f]<<" "<<jobs_[j].second<<" ";
+      out<<std::fixed<<std::setprecision(0)<<r.nmeas<<" ";
+      out<<std::scientific<<std::setprecision(10)<<r.energy<<" ";
+      out<<std::setprecision(3)<<r.error<<" "<<r.tau<<" "<<(r.converged?1:0)<<" ";
+      out<<std::fixed<<std::setprecision(3)<<r.seconds<<std::endl;
+      out.unsetf(std::ios_base::floatfield);
+    }
+  }
+
+private:
+
+  void RunJob(int j){
+    const int f=jobs_[j].first;
+    const std::string key=std::to_string(wfs_[f]->Nspins())+"_"+std::to_string(couplings_[f]);
+
+    if(models_[f]=="Ising1d"){
+      RunJob(j,*ising1d_[key]);
+    }
+    else if(models_[f]=="Heisenberg1d"){
+      RunJob(j,*heisenberg1d_[key]);
+    }
+    else{
+      RunJob(j,*heisenberg2d_[key]);
+    }
+  }
+
+  template<class Hamiltonian> void RunJob(int j,Hamiltonian & hamiltonian){
+    const auto start=std::chrono::steady_clock::now();
+
+    //the copy shares the parameters, and owns its look-up tables
+    Nqs wf(*wfs_[jobs_[j].first]);
+
+    Sampler<Nqs,Hamiltonian,Rng> sampler(wf,hamiltonian,jobs_[j].second);
+    sampler.SetVerbose(false);
+    sampler.SetBatchedProposals(batched_);
+    sampler.SetLocalMoves(localratio_);
+    sampler.SetTargetError(targeterror_);
+
+    const double thermfactor=0.1;
+    const int sweepfactor=1;
+    const int nflips=sampler.CheckInput(nsweeps_,thermfactor,-1);
+
+    sampler.Thermalize(nsweeps_*thermfactor,sweepfactor,nflips);
+    sampler.Sweep(nsweeps_,sweepfactor,nflips);
+
+    Result & r=results_[j];
+    r.energy=sampler.Energy();
+    r.error=sampler.EnergyError();
+    r.tau=sampler.Measurements().Tau();
+    r.nmeas=sampler.Measurements().Count();
+    r.converged=sampler.Measurements().Converged();
+    r.seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  }
+
+};
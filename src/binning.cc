@@ -0,0 +1,227 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include <vector>
+#include <cmath>
+
+//Online logarithmic binning analysis (H. Flyvbjerg and H. G. Petersen,
+//J. Chem. Phys. 91, 461 (1989)) of a correlated time series
+//
+//At level l the series is divided in blocks of 2^l consecutive samples.
+//Block averages are formed on the fly pairing the blocks of the previous
+//level, so that only O(log n) memory is needed for n samples.
+//For every level the mean and the variance of the block averages are
+//accumulated with Welford's algorithm.
+//The statistical error estimated at level l grows with l until the block
+//size exceeds the autocorrelation time, after which it stays constant
+//(plateau). The integrated autocorrelation time follows from the ratio
+//between the plateau error and the naive (level 0) error.
+class Binning{
+
+  //number of completed blocks at each level
+  std::vector<double> n_;
+
+  //running mean and sum of squared deviations of the block averages
+  std::vector<double> mean_;
+  std::vector<double> m2_;
+
+  //block average waiting to be paired, at each level
+  std::vector<double> pending_;
+  std::vector<bool> haspending_;
+
+  //minimum number of blocks for a level to be used in the error analysis
+  int minblocks_;
+
+public:
+
+  Binning(int minblocks=32):minblocks_(minblocks){}
+
+  void Reset(){
+    n_.clear();
+    mean_.clear();
+    m2_.clear();
+    pending_.clear();
+    haspending_.clear();
+  }
+
+  //adds a new sample to the time series
+  void Add(double x){
+    int l=0;
+    while(true){
+      if(l==int(n_.size())){
+        n_.push_back(0);
+        mean_.push_back(0);
+        m2_.push_back(0);
+        pending_.push_back(0);
+        haspending_.push_back(false);
+      }
+
+      n_[l]+=1;
+      const double delta=x-mean_[l];
+      mean_[l]+=delta/n_[l];
+      m2_[l]+=delta*(x-mean_[l]);
+
+      if(!haspending_[l]){
+        pending_[l]=x;
+        haspending_[l]=true;
+        return;
+      }
+
+      //a block of the next level is completed
+      x=0.5*(pending_[l]+x);
+      haspending_[l]=false;
+      l++;
+    }
+  }
+
+  //merges the statistics of an independent time series
+  //blocks never extend across the two series, and the incomplete blocks
+  //of the other series are discarded
+  void Merge(const Binning & other){
+    for(int l=0;l<other.Levels();l++){
+      if(l==Levels()){
+        n_.push_back(0);
+        mean_.push_back(0);
+        m2_.push_back(0);
+        pending_.push_back(0);
+        haspending_.push_back(false);
+      }
+      const double n=n_[l]+other.n_[l];
+      if(n==0){
+        continue;
+      }
+      const double delta=other.mean_[l]-mean_[l];
+      m2_[l]+=other.m2_[l]+delta*delta*n_[l]*other.n_[l]/n;
+      mean_[l]+=delta*other.n_[l]/n;
+      n_[l]=n;
+    }
+  }
+
+  //binary image for checkpoints (see checkpoint.cc)
+  void Save(CheckpointWriter & out)const{
+    out.Put(n_);
+    out.Put(mean_);
+    out.Put(m2_);
+    out.Put(pending_);
+    out.Put(haspending_);
+  }
+
+  void Load(CheckpointReader & in){
+    in.Get(n_);
+    in.Get(mean_);
+    in.Get(m2_);
+    in.Get(pending_);
+    in.Get(haspending_);
+    const std::size_t nl=n_.size();
+    if(mean_.size()!=nl || m2_.size()!=nl || pending_.size()!=nl || haspending_.size()!=nl){
+      in.Fail("inconsistent binning data");
+    }
+  }
+
+  //number of levels
+  inline int Levels()const{
+    return n_.size();
+  }
+
+  //number of samples
+  inline double Count()const{
+    return (Levels()>0)?n_[0]:0;
+  }
+
+  //number of blocks at level l, each of 2^l samples
+  inline double Count(int l)const{
+    return n_[l];
+  }
+
+  //mean of the time series
+  inline double Mean()const{
+    return (Levels()>0)?mean_[0]:0;
+  }
+
+  //estimated error of the mean at level l
+  inline double Error(int l)const{
+    if(n_[l]<2){
+      return 0;
+    }
+    return std::sqrt(m2_[l]/(n_[l]-1.)/n_[l]);
+  }
+
+  //statistical uncertainty of Error(l)
+  inline double ErrorOfError(int l)const{
+    if(n_[l]<2){
+      return 0;
+    }
+    return Error(l)/std::sqrt(2.*(n_[l]-1.));
+  }
+
+  //deepest level with at least minblocks blocks
+  inline int MaxLevel()const{
+    int l=Levels()-1;
+    while(l>0 && n_[l]<minblocks_){
+      l--;
+    }
+    return l;
+  }
+
+  //level at which the error reaches its plateau
+  //it is the first level whose error is compatible (within two standard
+  //deviations) with the errors of all the deeper levels
+  int PlateauLevel()const{
+    const int lmax=MaxLevel();
+    for(int l=0;l<lmax;l++){
+      bool plateau=true;
+      for(int lp=l+1;lp<=lmax;lp++){
+        if(Error(lp)-Error(l)>2.*ErrorOfError(lp)){
+          plateau=false;
+          break;
+        }
+      }
+      if(plateau){
+        return l;
+      }
+    }
+    return lmax;
+  }
+
+  //true if the plateau is confirmed by at least one deeper level
+  inline bool Converged()const{
+    return Levels()>0 && PlateauLevel()<MaxLevel();
+  }
+
+  //best estimate of the error of the mean
+  inline double Error()const{
+    return (Levels()>0)?Error(PlateauLevel()):0;
+  }
+
+  //integrated autocorrelation time, in units of the sampling interval
+  inline double Tau()const{
+    if(Levels()==0 || Error(0)==0){
+      return 0;
+    }
+    const double ratio=Error()/Error(0);
+    return 0.5*ratio*ratio;
+  }
+
+};
@@ -0,0 +1,220 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+//Binary checkpoints of the state of the samplers
+//
+//A checkpoint file is made of a header of 32 bytes
+//  char     magic[8]   "NQSCHKPT"
+//  int64    version
+//  int64    payload    size of the payload in bytes
+//  uint64   checksum   64-bit FNV-1a of the payload
+//followed by the payload, the concatenation of the binary images
+//of the saved objects, each of them implementing
+//  Save(CheckpointWriter &) const
+//  Load(CheckpointReader &)
+//Files are written to FILENAME.tmp, synchronized to disk and then renamed,
+//so that FILENAME always contains a complete checkpoint
+
+const char CheckpointMagic[9]="NQSCHKPT";
+const std::int64_t CheckpointVersion=3;
+
+inline std::uint64_t CheckpointChecksum(const std::string & payload){
+  std::uint64_t hash=14695981039346656037ULL;
+  for(const auto & c : payload){
+    hash^=std::uint8_t(c);
+    hash*=1099511628211ULL;
+  }
+  return hash;
+}
+
+class CheckpointWriter{
+
+  std::string payload_;
+
+public:
+
+  template<class T> void Put(const T & x){
+    payload_.append(reinterpret_cast<const char *>(&x),sizeof(T));
+  }
+
+  template<class T,class A> void Put(const std::vector<T,A> & v){
+    Put(std::int64_t(v.size()));
+    payload_.append(reinterpret_cast<const char *>(v.data()),v.size()*sizeof(T));
+  }
+
+  void Put(const std::vector<bool> & v){
+    Put(std::int64_t(v.size()));
+    for(const bool b : v){
+      Put(std::uint8_t(b));
+    }
+  }
+
+  void Put(const std::string & s){
+    Put(std::int64_t(s.size()));
+    payload_.append(s);
+  }
+
+  //writes the checkpoint atomically on the given file
+  void Write(std::string filename)const{
+    char header[32];
+    std::memset(header,0,sizeof(header));
+    std::memcpy(header,CheckpointMagic,8);
+    const std::int64_t size=payload_.size();
+    const std::uint64_t checksum=CheckpointChecksum(payload_);
+    std::memcpy(header+8,&CheckpointVersion,8);
+    std::memcpy(header+16,&size,8);
+    std::memcpy(header+24,&checksum,8);
+
+    const std::string tmpname=filename+".tmp";
+    const int fd=open(tmpname.c_str(),O_WRONLY|O_CREAT|O_TRUNC,0644);
+    bool ok=(fd>=0);
+    ok=ok && WriteAll(fd,header,sizeof(header));
+    ok=ok && WriteAll(fd,payload_.data(),payload_.size());
+    ok=ok && fsync(fd)==0;
+    if(fd>=0){
+      ok=(close(fd)==0) && ok;
+    }
+    ok=ok && std::rename(tmpname.c_str(),filename.c_str())==0;
+
+    if(!ok){
+      std::cerr<<"# Error : Cannot write the checkpoint file "<<filename<<std::endl;
+      std::abort();
+    }
+  }
+
+private:
+
+  static bool WriteAll(int fd,const char * data,std::size_t size){
+    while(size>0){
+      const ssize_t written=write(fd,data,size);
+      if(written<=0){
+        return false;
+      }
+      data+=written;
+      size-=written;
+    }
+    return true;
+  }
+
+};
+
+class CheckpointReader{
+
+  std::string payload_;
+  std::size_t pos_;
+  std::string filename_;
+
+public:
+
+  CheckpointReader(std::string filename):pos_(0),filename_(filename){
+    std::ifstream fin(filename.c_str(),std::ios::binary);
+    char header[32];
+    fin.read(header,sizeof(header));
+
+    std::int64_t version=0;
+    std::int64_t size=0;
+    std::uint64_t checksum=0;
+    std::memcpy(&version,header+8,8);
+    std::memcpy(&size,header+16,8);
+    std::memcpy(&checksum,header+24,8);
+
+    if(!fin.good() || std::memcmp(header,CheckpointMagic,8)!=0 || version!=CheckpointVersion || size<0){
+      Fail("not a valid checkpoint file");
+    }
+
+    payload_.resize(size);
+    fin.read(&payload_[0],size);
+
+    if(fin.gcount()!=size || CheckpointChecksum(payload_)!=checksum){
+      Fail("the file is truncated or corrupted");
+    }
+  }
+
+  //true if the file exists (and can be read)
+  static bool Exists(std::string filename){
+    std::ifstream fin(filename.c_str(),std::ios::binary);
+    return fin.good();
+  }
+
+  template<class T> void Get(T & x){
+    Need(sizeof(T));
+    std::memcpy(&x,payload_.data()+pos_,sizeof(T));
+    pos_+=sizeof(T);
+  }
+
+  template<class T,class A> void Get(std::vector<T,A> & v){
+    std::int64_t n;
+    Get(n);
+    Need(n*sizeof(T));
+    v.resize(n);
+    std::memcpy(v.data(),payload_.data()+pos_,n*sizeof(T));
+    pos_+=n*sizeof(T);
+  }
+
+  void Get(std::vector<bool> & v){
+    std::int64_t n;
+    Get(n);
+    v.resize(n);
+    for(std::int64_t i=0;i<n;i++){
+      std::uint8_t b;
+      Get(b);
+      v[i]=b;
+    }
+  }
+
+  void Get(std::string & s){
+    std::int64_t n;
+    Get(n);
+    Need(n);
+    s=payload_.substr(pos_,n);
+    pos_+=n;
+  }
+
+  //aborts with an error message about the checkpoint
+  void Fail(std::string message)const{
+    std::cerr<<"# Error : Cannot load the checkpoint file "<<filename_<<" : "<<message<<std::endl;
+    std::abort();
+  }
+
+private:
+
+  void Need(std::int64_t size)const{
+    if(size<0 || pos_+size>payload_.size()){
+      Fail("unexpected end of data");
+    }
+  }
+
+};
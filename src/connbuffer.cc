@@ -0,0 +1,112 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include <vector>
+#include <complex>
+
+//Flat container for the non-zero matrix elements of a hamiltonian on a state
+//i.e. all the state' such that <state'|H|state> = mel(state') \neq 0
+//state' is encoded as the sequence of spin flips to be performed on state
+//
+//The flips of all the connected states are stored contiguously,
+//the flips of the i-th connected state being
+//flips_[offsets_[i]] ... flips_[offsets_[i+1]-1]
+//Clear() keeps the allocated memory, so that once the buffer has grown to
+//its largest size filling it again does not allocate
+class ConnBuffer{
+
+  //non-zero matrix elements
+  std::vector<std::complex<double> > mel_;
+
+  //sites to be flipped, for all the connected states
+  std::vector<int> flips_;
+
+  //offsets of the flips of each connected state in flips_
+  std::vector<int> offsets_;
+
+public:
+
+  ConnBuffer(){
+    Clear();
+  }
+
+  inline void Clear(){
+    mel_.clear();
+    flips_.clear();
+    offsets_.clear();
+    offsets_.push_back(0);
+  }
+
+  inline void Reserve(int nconn,int nflips){
+    mel_.reserve(nconn);
+    flips_.reserve(nflips);
+    offsets_.reserve(nconn+1);
+  }
+
+  //connected state equal to the given state (diagonal matrix element)
+  inline void Add(std::complex<double> mel){
+    mel_.push_back(mel);
+    offsets_.push_back(flips_.size());
+  }
+
+  //connected state with one flipped spin
+  inline void Add(std::complex<double> mel,int si){
+    mel_.push_back(mel);
+    flips_.push_back(si);
+    offsets_.push_back(flips_.size());
+  }
+
+  //connected state with two flipped spins
+  inline void Add(std::complex<double> mel,int si,int sj){
+    mel_.push_back(mel);
+    flips_.push_back(si);
+    flips_.push_back(sj);
+    offsets_.push_back(flips_.size());
+  }
+
+  //number of connected states
+  inline int Size()const{
+    return mel_.size();
+  }
+
+  inline const std::complex<double> & Mel(int i)const{
+    return mel_[i];
+  }
+
+  inline std::complex<double> & Mel(int i){
+    return mel_[i];
+  }
+
+  //sites to be flipped to obtain the i-th connected state
+  inline const int * Flips(int i)const{
+    return flips_.data()+offsets_[i];
+  }
+
+  //number of sites to be flipped to obtain the i-th connected state
+  inline int NFlips(int i)const{
+    return offsets_[i+1]-offsets_[i];
+  }
+
+};
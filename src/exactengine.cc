@@ -0,0 +1,269 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+//Exact expectation values obtained enumerating all the configurations
+//of the spins, or only the ones with zero total magnetization
+//It is meant as a noise-free reference for the Monte Carlo results
+//on small systems (up to about 30 spins)
+//Configurations are visited in Gray-code order, so that successive states
+//differ by a single spin flip and the look-up tables of the wave-function
+//are updated incrementally
+//The Gray sequence is split into chunks, processed in parallel by a pool of
+//threads, each owning a copy of the wave-function
+template<class Wf,class Hamiltonian> class ExactEngine{
+
+  //weighted sums over the configurations
+  //weights |Psi|^2 are stored relative to exp(logref) to avoid overflows
+  struct Accumulator{
+    double logref;
+    double norm;
+    std::complex<double> energy;
+    double energy2;
+
+    Accumulator():logref(0.),norm(0.),energy(0.),energy2(0.){}
+
+    void Rescale(double logref1){
+      const double scale=std::exp(logref-logref1);
+      norm*=scale;
+      energy*=scale;
+      energy2*=scale;
+      logref=logref1;
+    }
+
+    //adds a configuration of weight exp(logw) and local energy eloc
+    inline void Add(double logw,std::complex<double> eloc){
+      if(norm==0){
+        logref=logw;
+      }
+      else if(logw>logref){
+        Rescale(logw);
+      }
+      const double w=std::exp(logw-logref);
+      norm+=w;
+      energy+=w*eloc;
+      energy2+=w*std::norm(eloc);
+    }
+
+    void Merge(const Accumulator & other){
+      if(other.norm==0){
+        return;
+      }
+      if(norm==0){
+        *this=other;
+        return;
+      }
+      Accumulator o=other;
+      if(o.logref>logref){
+        Rescale(o.logref);
+      }
+      else{
+        o.Rescale(logref);
+      }
+      norm+=o.norm;
+      energy+=o.energy;
+      energy2+=o.energy2;
+    }
+  };
+
+  //wave-function
+  const Wf & wf_;
+
+  //Hamiltonian
+  const Hamiltonian & hamiltonian_;
+
+  //number of spins
+  const int nspins_;
+
+  //number of threads
+  const int nthreads_;
+
+  //if true only the configurations with zero magnetization are enumerated
+  bool sz0_;
+
+  //number of Gray-code steps per chunk
+  static const std::uint64_t chunksize_=std::uint64_t(1)<<14;
+
+  //result of the last enumeration
+  Accumulator result_;
+  double nstates_;
+
+public:
+
+  //largest number of spins accepted
+  static const int maxspins_=36;
+
+  ExactEngine(const Wf & wf,const Hamiltonian & hamiltonian,int nthreads,bool sz0):
+    wf_(wf),hamiltonian_(hamiltonian),nspins_(wf.Nspins()),nthreads_(nthreads),sz0_(sz0),nstates_(0){
+
+    if(nthreads_<1){
+      std::cerr<<"# Error : The number of threads should be a positive integer"<<std::endl;
+      std::abort();
+    }
+    if(nspins_>maxspins_){
+      std::cerr<<"# Error : Exact enumeration is possible only for up to "<<maxspins_<<" spins"<<std::endl;
+      std::abort();
+    }
+    //restricting the sum to zero magnetization gives the expectation value
+    //only if the Hamiltonian does not couple it to the other sectors
+    if(sz0_ && !hamiltonian_.ConservesSz()){
+      std::cerr<<"# Error : Cannot restrict the enumeration to zero magnetization, the Hamiltonian does not conserve it"<<std::endl;
+      std::abort();
+    }
+    if(sz0_ && nspins_%2){
+      std::cerr<<"# Error : Cannot enumerate states with zero magnetization for odd number of spins"<<std::endl;
+      std::abort();
+    }
+  }
+
+  //Enumerates all the configurations and computes the exact energy
+  void Run(){
+
+    const std::uint64_t nconf=std::uint64_t(1)<<nspins_;
+    const std::uint64_t nchunks=(nconf+chunksize_-1)/chunksize_;
+
+    std::cout<<"# Starting exact enumeration of "<<(sz0_?"zero magnetization":"all");
+    std::cout<<" configurations of "<<nspins_<<" spins on "<<nthreads_<<" threads"<<std::endl;
+    std::cout<<"# Enumerating... ";
+    std::flush(std::cout);
+
+    //chunks are assigned dynamically, but their results are merged in
+    //a fixed order so that the result does not depend on the number of threads
+    std::vector<Accumulator> chunks(nchunks);
+    std::vector<double> nstates(nchunks,0.);
+    std::atomic<std::uint64_t> next(0);
+
+    std::vector<std::thread> threads;
+
+    for(int t=0;t<nthreads_;t++){
+      threads.push_back(std::thread([this,&chunks,&nstates,&next,nconf,nchunks](){
+        Wf wf(wf_);
+        ConnBuffer conn;
+        std::vector<std::complex<double> > pops;
+        std::vector<int> state(nspins_);
+        SpinConfig config;
+
+        for(std::uint64_t c=next++;c<nchunks;c=next++){
+          const std::uint64_t k0=c*chunksize_;
+          const std::uint64_t k1=std::min(k0+chunksize_,nconf);
+          nstates[c]=Enumerate(wf,conn,pops,state,config,k0,k1,chunks[c]);
+        }
+      }));
+    }
+
+    for(auto & thread : threads){
+      thread.join();
+    }
+
+    result_=Accumulator();
+    nstates_=0;
+    for(std::uint64_t c=0;c<nchunks;c++){
+      result_.Merge(chunks[c]);
+      nstates_+=nstates[c];
+    }
+
+    std::cout<<" DONE "<<std::endl;
+
+    OutputEnergy();
+  }
+
+  //exact energy per spin
+  double Energy()const{
+    return result_.energy.real()/result_.norm/double(nspins_);
+  }
+
+  //variance of the local energy, vanishing on eigenstates
+  double Variance()const{
+    const double en=result_.energy.real()/result_.norm;
+    return std::max(result_.energy2/result_.norm-en*en,0.);
+  }
+
+  void OutputEnergy()const{
+    std::cout<<"# Number of enumerated configurations : ";
+    std::cout<<std::fixed<<std::setprecision(0)<<nstates_<<std::endl;
+    std::cout<<"# Exact average energy per spin : "<<std::endl;
+    std::cout<<"# "<<std::scientific<<std::setprecision(12)<<Energy()<<std::endl;
+    std::cout<<"# Variance of the local energy : "<<std::endl;
+    std::cout<<"# "<<std::scientific<<std::setprecision(6)<<Variance()<<std::endl;
+  }
+
+private:
+
+  //visits the configurations of the Gray code from k0 to k1-1
+  //bit i of the code set means spin i up
+  //returns the number of configurations in the sector
+  double Enumerate(Wf & wf,ConnBuffer & conn,std::vector<std::complex<double> > & pops,
+    std::vector<int> & state,SpinConfig & config,std::uint64_t k0,std::uint64_t k1,Accumulator & acc)const{
+
+    const std::uint64_t g0=k0^(k0>>1);
+
+    int mag=0;
+    for(int i=0;i<nspins_;i++){
+      state[i]=((g0>>i)&1)?1:-1;
+      mag+=state[i];
+    }
+    config.Set(state);
+    wf.InitLt(state);
+
+    double nstates=0;
+
+    for(std::uint64_t k=k0;k<k1;k++){
+
+      if(!sz0_ || mag==0){
+        hamiltonian_.FindConn(config,conn);
+        wf.PoP(state,conn,pops);
+
+        std::complex<double> eloc=0.;
+        for(int i=0;i<conn.Size();i++){
+          eloc+=pops[i]*conn.Mel(i);
+        }
+
+        acc.Add(2.*wf.LogValLt(state).real(),eloc);
+        nstates+=1;
+      }
+
+      //the next code differs in the lowest set bit of k+1
+      if(k+1<k1){
+        const int flip=__builtin_ctzll(k+1);
+        wf.UpdateLt(state,&flip,1);
+        mag-=2*state[flip];
+        state[flip]*=-1;
+        config.Flip(flip);
+      }
+    }
+
+    return nstates;
+  }
+
+};
@@ -26,6 +26,7 @@ All use of these programs is entirely at the user's own risk.
 #include <iostream>
 #include <vector>
 #include <complex>
+#include <cstdint>
 
 //Anti-ferromagnetic Heisenberg model in 1d
 class Heisenberg1d{
@@ -50,44 +51,61 @@ public:
   //on the given state
   //i.e. all the state' such that <state'|H|state> = mel(state') \neq 0
   //state' is encoded as the sequence of spin flips to be performed on state
-  void FindConn(const std::vector<int> & state,std::vector<std::vector<int> > & flipsh,std::vector<std::complex<double> > & mel){
+  //the bit-packed configuration is processed 64 spins at a time
+  void FindConn(const SpinConfig & config,ConnBuffer & conn)const{
 
-    mel.resize(1);
-    flipsh.resize(1);
+    conn.Clear();
 
-    //computing interaction part Sz*Sz
-    mel[0]=0.;
+    //the diagonal element is computed below
+    conn.Add(0.);
 
-    for(int i=0;i<(nspins_-1);i++){
-      mel[0]+=double(state[i]*state[i+1]);
-    }
+    int nanti=0;
+
+    //Looks for possible spin flips
+    for(int k=0;k<config.NWords();k++){
+      const std::uint64_t anti=AntiAligned(config,k);
+      nanti+=__builtin_popcountll(anti);
 
-    if(pbc_){
-      mel[0]+=double(state[nspins_-1]*state[0]);
+      ForEachBit(anti,64*k,[&](int i){
+        conn.Add(-2,i,(i+1)%nspins_);
+      });
     }
 
-    mel[0]*=jz_;
+    //interaction part Sz*Sz, given by the number of anti-aligned bonds
+    const int nbonds=pbc_?nspins_:(nspins_-1);
+    conn.Mel(0)=jz_*double(nbonds-2*nanti);
+  }
 
-    //Looks for possible spin flips
-    for(int i=0;i<(nspins_-1);i++){
-      if(state[i]!=state[i+1]){
-        mel.push_back(-2);
-        flipsh.push_back(std::vector<int>({i,i+1}));
-      }
-    }
+  //bit i of the result is set if spins i and i+1 are anti-aligned
+  //for spins 64*k ... 64*k+63
+  inline std::uint64_t AntiAligned(const SpinConfig & config,int k)const{
+    std::uint64_t anti=config.Word(k)^config.Shifted(k,1);
 
-    if(pbc_){
-      if(state[nspins_-1]!=state[0]){
-        mel.push_back(-2);
-        flipsh.push_back(std::vector<int>({nspins_-1,0}));
-      }
+    //without pbc the last spin has no bond to the right
+    if(!pbc_ && k==(nspins_-1)/64){
+      anti&=~(std::uint64_t(1)<<((nspins_-1)&63));
     }
-
+    return anti;
   }
 
   int MinFlips()const{
     return 2;
   }
 
+  //the total magnetization is conserved
+  bool ConservesSz()const{
+    return true;
+  }
+
+  //pairs of nearest-neighbour sites
+  std::vector<std::vector<int> > Bonds()const{
+    std::vector<std::vector<int> > bonds;
+    const int nbonds=pbc_?nspins_:(nspins_-1);
+    for(int i=0;i<nbonds;i++){
+      bonds.push_back(std::vector<int>{i,(i+1)%nspins_});
+    }
+    return bonds;
+  }
+
 
 };
@@ -26,6 +26,7 @@ All use of these programs is entirely at the user's own risk.
 #include <iostream>
 #include <vector>
 #include <complex>
+#include <cstdint>
 
 //Anti-ferromagnetic Heisenberg model in 1d
 class Heisenberg2d{
@@ -46,6 +47,11 @@ class Heisenberg2d{
   std::vector<std::vector<int> > nn_;
 
   std::vector<std::vector<int> > bonds_;
+
+  //bit masks (one per 64-bit word of the configuration) of the sites
+  //in the last column and in the last row of the lattice
+  std::vector<std::uint64_t> lastcol_;
+  std::vector<std::uint64_t> lastrow_;
 public:
 
   Heisenberg2d(int nspins,double jz,bool pbc=true):nspins_(nspins),pbc_(pbc),jz_(jz),l_(std::sqrt(nspins_)){
@@ -78,6 +84,18 @@ public:
       }
     }
 
+    lastcol_.assign((nspins_+63)/64,0);
+    lastrow_.assign((nspins_+63)/64,0);
+
+    for(int i=0;i<nspins_;i++){
+      if((i+1)%l_==0){
+        lastcol_[i/64]|=(std::uint64_t(1)<<(i%64));
+      }
+      if(i>=nspins_-l_){
+        lastrow_[i/64]|=(std::uint64_t(1)<<(i%64));
+      }
+    }
+
   }
 
 
@@ -85,37 +103,67 @@ public:
   //on the given state
   //i.e. all the state' such that <state'|H|state> = mel(state') \neq 0
   //state' is encoded as the sequence of spin flips to be performed on state
-  void FindConn(const std::vector<int> & state,std::vector<std::vector<int> > & flipsh,std::vector<std::complex<double> > & mel){
+  //the bit-packed configuration is processed 64 spins at a time
+  void FindConn(const SpinConfig & config,ConnBuffer & conn)const{
 
-    mel.resize(1);
-    flipsh.resize(1);
+    conn.Clear();
 
-    //computing interaction part Sz*Sz
-    mel[0]=0.;
-
-    for(int i=0;i<bonds_.size();i++){
-      mel[0]+=double(state[bonds_[i][0]]*state[bonds_[i][1]]);
-    }
+    //the diagonal element is computed below
+    conn.Add(0.);
 
-    mel[0]*=jz_;
+    int nanti=0;
 
     //Looks for possible spin flips
-    for(int i=0;i<bonds_.size();i++){
-      const int si=bonds_[i][0];
-      const int sj=bonds_[i][1];
+    for(int k=0;k<config.NWords();k++){
+      const std::uint64_t antir=AntiAlignedRight(config,k);
+      const std::uint64_t antid=AntiAlignedDown(config,k);
+
+      nanti+=__builtin_popcountll(antir)+__builtin_popcountll(antid);
+
+      ForEachBit(antir,64*k,[&](int i){
+        conn.Add(-2,i,nn_[i][1]);
+      });
+      ForEachBit(antid,64*k,[&](int i){
+        conn.Add(-2,i,nn_[i][3]);
+      });
+    }
 
-      if(state[si]!=state[sj]){
-        mel.push_back(-2);
-        flipsh.push_back(std::vector<int>({si,sj}));
-      }
+    //interaction part Sz*Sz, given by the number of anti-aligned bonds
+    conn.Mel(0)=jz_*double(int(bonds_.size())-2*nanti);
+  }
+
+  //bit i of the result is set if spin i and its right neighbour are anti-aligned
+  //for spins 64*k ... 64*k+63
+  inline std::uint64_t AntiAlignedRight(const SpinConfig & config,int k)const{
+    if(pbc_){
+      //the right neighbour of the sites in the last column is l-1 sites behind
+      const std::uint64_t right=(config.Shifted(k,1)&~lastcol_[k])|(config.Shifted(k,nspins_-l_+1)&lastcol_[k]);
+      return config.Word(k)^right;
     }
+    return (config.Word(k)^config.Shifted(k,1))&~lastcol_[k];
+  }
 
+  //bit i of the result is set if spin i and its lower neighbour are anti-aligned
+  //for spins 64*k ... 64*k+63
+  inline std::uint64_t AntiAlignedDown(const SpinConfig & config,int k)const{
+    const std::uint64_t anti=config.Word(k)^config.Shifted(k,l_);
+    return pbc_?anti:(anti&~lastrow_[k]);
   }
 
   int MinFlips()const{
     return 2;
   }
 
+  //the total magnetization is conserved
+  bool ConservesSz()const{
+    return true;
+  }
+
+  //pairs of nearest-neighbour sites
+  const std::vector<std::vector<int> > & Bonds()const{
+    return bonds_;
+  }
+
 
   //Small functions to set up the lattice
   //Horizontal Pbc
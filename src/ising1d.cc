@@ -26,6 +26,7 @@ All use of these programs is entirely at the user's own risk.
 #include <iostream>
 #include <vector>
 #include <complex>
+#include <cstdint>
 
 //Transverse-field Ising model in 1d
 class Ising1d{
@@ -39,10 +40,6 @@ class Ising1d{
   //option to use periodic boundary conditions
   const bool pbc_;
 
-  //pre-computed quantities
-  std::vector<std::complex<double> > mel_;
-  std::vector<std::vector<int> > flipsh_;
-
 public:
 
   Ising1d(int nspins,double hfield,bool pbc=true):nspins_(nspins),hfield_(hfield),pbc_(pbc){
@@ -50,13 +47,6 @@ public:
   }
 
   void Init(){
-    mel_.resize(nspins_+1,0.);
-    flipsh_.resize(nspins_+1);
-
-    for(int i=0;i<nspins_;i++){
-      mel_[i+1]=-hfield_;
-      flipsh_[i+1]=std::vector<int>(1,i);
-    }
     std::cout<<"# Using the 1d Transverse-field Ising model with h = "<<hfield_<<std::endl;
   }
 
@@ -64,24 +54,31 @@ public:
   //on the given state
   //i.e. all the state' such that <state'|H|state> = mel(state') \neq 0
   //state' is encoded as the sequence of spin flips to be performed on state
-  void FindConn(const std::vector<int> & state,std::vector<std::vector<int> > & flipsh,std::vector<std::complex<double> > & mel){
+  //the bit-packed configuration is processed 64 spins at a time
+  void FindConn(const SpinConfig & config,ConnBuffer & conn)const{
 
-    mel.resize(nspins_+1);
-    flipsh.resize(nspins_+1);
-
-    //assigning pre-computed matrix elements and spin flips
-    mel=mel_;
-    flipsh=flipsh_;
+    conn.Clear();
 
     //computing interaction part Sz*Sz
-    mel[0]=0.;
+    //given by the number of anti-aligned nearest neighbours
+    int nanti=0;
+
+    for(int k=0;k<config.NWords();k++){
+      std::uint64_t anti=config.Word(k)^config.Shifted(k,1);
 
-    for(int i=0;i<(nspins_-1);i++){
-      mel[0]-=double(state[i]*state[i+1]);
+      //without pbc the last spin has no bond to the right
+      if(!pbc_ && k==(nspins_-1)/64){
+        anti&=~(std::uint64_t(1)<<((nspins_-1)&63));
+      }
+      nanti+=__builtin_popcountll(anti);
     }
 
-    if(pbc_){
-      mel[0]-=double(state[nspins_-1]*state[0]);
+    const int nbonds=pbc_?nspins_:(nspins_-1);
+    conn.Add(-double(nbonds-2*nanti));
+
+    //single spin flips due to the transverse field
+    for(int i=0;i<nspins_;i++){
+      conn.Add(-hfield_,i);
     }
 
   }
@@ -90,4 +87,19 @@ public:
     return 1;
   }
 
+  //the transverse field does not conserve the total magnetization
+  bool ConservesSz()const{
+    return false;
+  }
+
+  //pairs of nearest-neighbour sites
+  std::vector<std::vector<int> > Bonds()const{
+    std::vector<std::vector<int> > bonds;
+    const int nbonds=pbc_?nspins_:(nspins_-1);
+    for(int i=0;i<nbonds;i++){
+      bonds.push_back(std::vector<int>{i,(i+1)%nspins_});
+    }
+    return bonds;
+  }
+
 };
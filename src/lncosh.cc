@@ -0,0 +1,689 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <complex>
+#include <limits>
+#include <algorithm>
+
+//Batched evaluation of ln(cosh(x)) for complex arguments
+//
+//The NQS amplitudes require ln(cosh(theta_h)) for all the hidden units.
+//Here the complex argument x=xr+i*xi is passed as two separate real arrays
+//(real and imaginary planes), and the function is evaluated as
+//
+//  Re ln(cosh(x)) = |xr| - ln(2) + ln(1+exp(-2|xr|)) + 0.5*ln(cos(xi)^2+tanh(xr)^2*sin(xi)^2)
+//  Im ln(cosh(x)) = atan2(tanh(xr)*sin(xi),cos(xi))
+//
+//which is the same decomposition used by Nqs::lncosh, the imaginary part
+//being on the principal branch (-pi,pi].
+//
+//The polynomial kernel evaluates exp, log, sin, cos and atan with
+//branch-free range reductions and truncated series, so that the loop over
+//the hidden units is vectorized by the compiler.
+//Accuracy: for |xi|<1.0e5 the absolute error is below 1.0e-14+2.0e-16*|xr|
+//on the real part and below 1.0e-14 on the imaginary part (modulo 2*pi),
+//i.e. within a few units in the last place of the result.
+//The libm-based reference (LnCoshBatchScalar) is less accurate for |xr|>12,
+//where it neglects ln(1+exp(-2|xr|)), and differs from the polynomial
+//kernel by up to 4.0e-11 there.
+//Arguments with cos(xi)^2+tanh(xr)^2*sin(xi)^2 below the smallest normal
+//double (i.e. exact zeros of cosh) give a large negative, finite real part
+//instead of -infinity.
+//
+//The polynomial kernel is compiled for several instruction sets and the
+//best one supported by the CPU is chosen at run time (see LnCoshBatch).
+//Since no floating-point contraction is performed, all the variants give
+//bit-identical results.
+//Defining NQS_SCALAR_LNCOSH at compile time forces the libm reference path.
+//
+//A single-precision version (float arguments and results) is also provided,
+//with the same structure and shorter series. Its absolute error is below
+//2.0e-6+1.2e-7*|xr| on the real part and below 2.0e-6 on the imaginary part,
+//for |xi|<1.0e3.
+
+//The polynomial kernel is fully inlined in each instruction-set variant
+#if defined(__GNUC__)
+#define NQS_LNCOSH_INLINE inline __attribute__((always_inline))
+#else
+#define NQS_LNCOSH_INLINE inline
+#endif
+
+//Reference implementation based on the standard library
+inline void LnCoshBatchScalar(const double * xr,const double * xi,int n,double * yr,double * yi){
+  const double log2=std::log(2.);
+
+  for(int h=0;h<n;h++){
+    const double xp=std::abs(xr[h]);
+    double res=(xp<=12.)?std::log(std::cosh(xp)):(xp-log2);
+
+    std::complex<double> lnc=std::log( std::complex<double>(std::cos(xi[h]),std::tanh(xr[h])*std::sin(xi[h])) );
+    yr[h]=res+lnc.real();
+    yi[h]=lnc.imag();
+  }
+}
+
+inline void LnCoshBatchScalar(const float * xr,const float * xi,int n,float * yr,float * yi){
+  const float log2=std::log(2.f);
+
+  for(int h=0;h<n;h++){
+    const float xp=std::abs(xr[h]);
+    float res=(xp<=9.f)?std::log(std::cosh(xp)):(xp-log2);
+
+    std::complex<float> lnc=std::log( std::complex<float>(std::cos(xi[h]),std::tanh(xr[h])*std::sin(xi[h])) );
+    yr[h]=res+lnc.real();
+    yi[h]=lnc.imag();
+  }
+}
+
+//Bit-level conversions used by the polynomial kernel
+NQS_LNCOSH_INLINE double LnCoshAsDouble(std::uint64_t i){
+  double d;
+  std::memcpy(&d,&i,sizeof(d));
+  return d;
+}
+
+NQS_LNCOSH_INLINE std::uint64_t LnCoshAsInt(double d){
+  std::uint64_t i;
+  std::memcpy(&i,&d,sizeof(i));
+  return i;
+}
+
+//exp(v) for v<=0
+//arguments below -708 are clamped, giving exp(-708)~3e-308
+NQS_LNCOSH_INLINE double LnCoshExpNeg(double v){
+  //1.5*2^52, adding it rounds to the nearest integer
+  const double magic=6755399441055744.0;
+  const double log2e=1.4426950408889634;
+  const double ln2hi=6.93147180369123816490e-01;
+  const double ln2lo=1.90821492927058770002e-10;
+
+  v=std::max(v,-708.);
+
+  const double kr=v*log2e+magic;
+  const double k=kr-magic;
+  const double r=(v-k*ln2hi)-k*ln2lo;
+
+  //Taylor series, |r|<=0.35
+  double p=1./6227020800.;
+  p=p*r+1./479001600.;
+  p=p*r+1./39916800.;
+  p=p*r+1./3628800.;
+  p=p*r+1./362880.;
+  p=p*r+1./40320.;
+  p=p*r+1./5040.;
+  p=p*r+1./720.;
+  p=p*r+1./120.;
+  p=p*r+1./24.;
+  p=p*r+1./6.;
+  p=p*r+0.5;
+  p=p*r+1.;
+  p=p*r+1.;
+
+  //2^k built directly from the integer bits of kr
+  const std::uint64_t ki=LnCoshAsInt(kr)-LnCoshAsInt(magic);
+  const double scale=LnCoshAsDouble((ki+1023)<<52);
+
+  return p*scale;
+}
+
+//ln(y) for positive normal y
+NQS_LNCOSH_INLINE double LnCoshLog(double y){
+  const double ln2hi=6.93147180369123816490e-01;
+  const double ln2lo=1.90821492927058770002e-10;
+  const double sqrt2=1.4142135623730951;
+  const double two52=4503599627370496.0;
+
+  const std::uint64_t bits=LnCoshAsInt(y);
+
+  //mantissa in [1,2) and biased exponent
+  double m=LnCoshAsDouble((bits&0x000fffffffffffffULL)|0x3ff0000000000000ULL);
+  double e=LnCoshAsDouble((bits>>52)|0x4330000000000000ULL)-two52-1023.;
+
+  //mantissa in [sqrt(2)/2,sqrt(2))
+  const bool big=(m>sqrt2);
+  const double mhalf=0.5*m;
+  const double eplus=e+1.;
+  m=big?mhalf:m;
+  e=big?eplus:e;
+
+  //ln(m)=2*atanh(f), |f|<=0.1716
+  const double f=(m-1.)/(m+1.);
+  const double s=f*f;
+
+  double p=1./25.;
+  p=p*s+1./23.;
+  p=p*s+1./21.;
+  p=p*s+1./19.;
+  p=p*s+1./17.;
+  p=p*s+1./15.;
+  p=p*s+1./13.;
+  p=p*s+1./11.;
+  p=p*s+1./9.;
+  p=p*s+1./7.;
+  p=p*s+1./5.;
+  p=p*s+1./3.;
+
+  return e*ln2hi+(2.*f+(2.*f*s*p+e*ln2lo));
+}
+
+//sin(x) and cos(x), accurate for |x|<1.0e5
+NQS_LNCOSH_INLINE void LnCoshSinCos(double x,double & sinx,double & cosx){
+  const double magic=6755399441055744.0;
+  const double twoopi=6.36619772367581382433e-01;
+  const double pio2_1=1.57079632673412561417e+00;
+  const double pio2_2=6.07710050630396597660e-11;
+  const double pio2_2t=2.02226624879595063154e-21;
+
+  const double kr=x*twoopi+magic;
+  const double k=kr-magic;
+  const double r=((x-k*pio2_1)-k*pio2_2)-k*pio2_2t;
+  const double r2=r*r;
+
+  //Taylor series, |r|<=pi/4
+  double s=-1./121645100408832000.;
+  s=s*r2+1./355687428096000.;
+  s=s*r2-1./1307674368000.;
+  s=s*r2+1./6227020800.;
+  s=s*r2-1./39916800.;
+  s=s*r2+1./362880.;
+  s=s*r2-1./5040.;
+  s=s*r2+1./120.;
+  s=s*r2-1./6.;
+  s=r+r*r2*s;
+
+  double c=1./6402373705728000.;
+  c=c*r2-1./20922789888000.;
+  c=c*r2+1./87178291200.;
+  c=c*r2-1./479001600.;
+  c=c*r2+1./3628800.;
+  c=c*r2-1./40320.;
+  c=c*r2+1./720.;
+  c=c*r2-1./24.;
+  c=c*r2+0.5;
+  c=1.-r2*c;
+
+  //quadrant
+  const std::uint64_t q=LnCoshAsInt(kr)&3;
+
+  //selections and sign changes are done on the bits,
+  //so that no 64-bit integer comparison is needed
+  const std::uint64_t odd=std::uint64_t(0)-(q&1);
+  const std::uint64_t sb=LnCoshAsInt(s);
+  const std::uint64_t cb=LnCoshAsInt(c);
+
+  const std::uint64_t sq=(cb&odd)|(sb&~odd);
+  const std::uint64_t cq=(sb&odd)|(cb&~odd);
+
+  sinx=LnCoshAsDouble(sq^((q&2)<<62));
+  cosx=LnCoshAsDouble(cq^(((q+1)&2)<<62));
+}
+
+//atan2(y,x) on the principal branch
+NQS_LNCOSH_INLINE double LnCoshAtan2(double y,double x){
+  const double pi=3.14159265358979311600e+00;
+  const double pio2=1.57079632679489655800e+00;
+  const double pio4=7.85398163397448278999e-01;
+  const double tanpio8=0.41421356237309503;
+
+  const double ax=std::abs(x);
+  const double ay=std::abs(y);
+  const double mx=std::max(ax,ay);
+  const double mn=std::min(ax,ay);
+
+  double t=mn/std::max(mx,std::numeric_limits<double>::min());
+
+  //reduction to |t|<=tan(pi/8)
+  const bool red=(t>tanpio8);
+  const double tred=(t-1.)/(t+1.);
+  t=red?tred:t;
+
+  const double s=t*t;
+
+  //Taylor series of atan
+  double p=-1./43.;
+  p=p*s+1./41.;
+  p=p*s-1./39.;
+  p=p*s+1./37.;
+  p=p*s-1./35.;
+  p=p*s+1./33.;
+  p=p*s-1./31.;
+  p=p*s+1./29.;
+  p=p*s-1./27.;
+  p=p*s+1./25.;
+  p=p*s-1./23.;
+  p=p*s+1./21.;
+  p=p*s-1./19.;
+  p=p*s+1./17.;
+  p=p*s-1./15.;
+  p=p*s+1./13.;
+  p=p*s-1./11.;
+  p=p*s+1./9.;
+  p=p*s-1./7.;
+  p=p*s+1./5.;
+  p=p*s-1./3.;
+
+  double a=t+t*s*p;
+  const double ared=a+pio4;
+  a=red?ared:a;
+  const double acompl=pio2-a;
+  a=(ay>ax)?acompl:a;
+  const double aneg=pi-a;
+  a=(x<0.)?aneg:a;
+
+  return std::copysign(a,y);
+}
+
+//Polynomial kernel, in a form that the compiler can vectorize
+NQS_LNCOSH_INLINE void LnCoshBatchPolyImpl(const double * __restrict__ xr,const double * __restrict__ xi,int n,double * __restrict__ yr,double * __restrict__ yi){
+  const double log2=6.93147180559945286227e-01;
+  const double tiny=std::numeric_limits<double>::min();
+
+  for(int h=0;h<n;h++){
+    const double x=xr[h];
+    const double ax=std::abs(x);
+
+    //exp(-2|x|) and tanh(x)
+    const double e=LnCoshExpNeg(-2.*ax);
+    const double th=std::copysign((1.-e)/(1.+e),x);
+
+    double sy,cy;
+    LnCoshSinCos(xi[h],sy,cy);
+
+    const double tsy=th*sy;
+    const double mod2=std::max(cy*cy+tsy*tsy,tiny);
+
+    yr[h]=(ax-log2)+LnCoshLog(1.+e)+0.5*LnCoshLog(mod2);
+    yi[h]=LnCoshAtan2(tsy,cy);
+  }
+}
+
+//Single-precision versions of the functions above
+
+NQS_LNCOSH_INLINE float LnCoshAsFloat(std::uint32_t i){
+  float f;
+  std::memcpy(&f,&i,sizeof(f));
+  return f;
+}
+
+NQS_LNCOSH_INLINE std::uint32_t LnCoshAsInt(float f){
+  std::uint32_t i;
+  std::memcpy(&i,&f,sizeof(i));
+  return i;
+}
+
+//exp(v) for v<=0
+//arguments below -87 are clamped, giving exp(-87)~1.6e-38
+NQS_LNCOSH_INLINE float LnCoshExpNeg(float v){
+  //1.5*2^23, adding it rounds to the nearest integer
+  const float magic=12582912.f;
+  const float log2e=1.44269502f;
+  const float ln2hi=0.693359375f;
+  const float ln2lo=-2.12194440e-4f;
+
+  v=std::max(v,-87.f);
+
+  const float kr=v*log2e+magic;
+  const float k=kr-magic;
+  const float r=(v-k*ln2hi)-k*ln2lo;
+
+  //Taylor series, |r|<=0.35
+  float p=1.f/40320.f;
+  p=p*r+1.f/5040.f;
+  p=p*r+1.f/720.f;
+  p=p*r+1.f/120.f;
+  p=p*r+1.f/24.f;
+  p=p*r+1.f/6.f;
+  p=p*r+0.5f;
+  p=p*r+1.f;
+  p=p*r+1.f;
+
+  //2^k built directly from the integer bits of kr
+  const std::uint32_t ki=LnCoshAsInt(kr)-LnCoshAsInt(magic);
+  const float scale=LnCoshAsFloat((ki+127)<<23);
+
+  return p*scale;
+}
+
+//ln(y) for positive normal y
+NQS_LNCOSH_INLINE float LnCoshLog(float y){
+  const float ln2hi=0.693359375f;
+  const float ln2lo=-2.12194440e-4f;
+  const float sqrt2=1.41421356f;
+  const float two23=8388608.f;
+
+  const std::uint32_t bits=LnCoshAsInt(y);
+
+  //mantissa in [1,2) and biased exponent
+  float m=LnCoshAsFloat((bits&0x007fffffU)|0x3f800000U);
+  float e=LnCoshAsFloat((bits>>23)|0x4b000000U)-two23-127.f;
+
+  //mantissa in [sqrt(2)/2,sqrt(2))
+  const bool big=(m>sqrt2);
+  const float mhalf=0.5f*m;
+  const float eplus=e+1.f;
+  m=big?mhalf:m;
+  e=big?eplus:e;
+
+  //ln(m)=2*atanh(f), |f|<=0.1716
+  const float f=(m-1.f)/(m+1.f);
+  const float s=f*f;
+
+  float p=1.f/11.f;
+  p=p*s+1.f/9.f;
+  p=p*s+1.f/7.f;
+  p=p*s+1.f/5.f;
+  p=p*s+1.f/3.f;
+
+  return e*ln2hi+(2.f*f+(2.f*f*s*p+e*ln2lo));
+}
+
+//sin(x) and cos(x), accurate for |x|<1.0e3
+NQS_LNCOSH_INLINE void LnCoshSinCos(float x,float & sinx,float & cosx){
+  const float magic=12582912.f;
+  const float twoopi=0.636619772f;
+  const float pio2_1=1.5703125f;
+  const float pio2_2=4.83751297e-4f;
+  const float pio2_3=7.54978995e-8f;
+
+  const float kr=x*twoopi+magic;
+  const float k=kr-magic;
+  const float r=((x-k*pio2_1)-k*pio2_2)-k*pio2_3;
+  const float r2=r*r;
+
+  //Taylor series, |r|<=pi/4
+  float s=1.f/362880.f;
+  s=s*r2-1.f/5040.f;
+  s=s*r2+1.f/120.f;
+  s=s*r2-1.f/6.f;
+  s=r+r*r2*s;
+
+  float c=-1.f/3628800.f;
+  c=c*r2+1.f/40320.f;
+  c=c*r2-1.f/720.f;
+  c=c*r2+1.f/24.f;
+  c=c*r2-0.5f;
+  c=1.f+r2*c;
+
+  //quadrant
+  const std::uint32_t q=LnCoshAsInt(kr)&3;
+
+  const std::uint32_t odd=std::uint32_t(0)-(q&1);
+  const std::uint32_t sb=LnCoshAsInt(s);
+  const std::uint32_t cb=LnCoshAsInt(c);
+
+  const std::uint32_t sq=(cb&odd)|(sb&~odd);
+  const std::uint32_t cq=(sb&odd)|(cb&~odd);
+
+  sinx=LnCoshAsFloat(sq^((q&2)<<30));
+  cosx=LnCoshAsFloat(cq^(((q+1)&2)<<30));
+}
+
+//atan2(y,x) on the principal branch
+NQS_LNCOSH_INLINE float LnCoshAtan2(float y,float x){
+  const float pi=3.14159265f;
+  const float pio2=1.57079633f;
+  const float pio4=0.785398163f;
+  const float tanpio8=0.414213562f;
+
+  const float ax=std::abs(x);
+  const float ay=std::abs(y);
+  const float mx=std::max(ax,ay);
+  const float mn=std::min(ax,ay);
+
+  float t=mn/std::max(mx,std::numeric_limits<float>::min());
+
+  //reduction to |t|<=tan(pi/8)
+  const bool red=(t>tanpio8);
+  const float tred=(t-1.f)/(t+1.f);
+  t=red?tred:t;
+
+  const float s=t*t;
+
+  //Taylor series of atan
+  float p=1.f/21.f;
+  p=p*s-1.f/19.f;
+  p=p*s+1.f/17.f;
+  p=p*s-1.f/15.f;
+  p=p*s+1.f/13.f;
+  p=p*s-1.f/11.f;
+  p=p*s+1.f/9.f;
+  p=p*s-1.f/7.f;
+  p=p*s+1.f/5.f;
+  p=p*s-1.f/3.f;
+
+  float a=t+t*s*p;
+  const float ared=a+pio4;
+  a=red?ared:a;
+  const float acompl=pio2-a;
+  a=(ay>ax)?acompl:a;
+  const float aneg=pi-a;
+  a=(x<0.f)?aneg:a;
+
+  return std::copysign(a,y);
+}
+
+NQS_LNCOSH_INLINE void LnCoshBatchPolyImpl(const float * __restrict__ xr,const float * __restrict__ xi,int n,float * __restrict__ yr,float * __restrict__ yi){
+  const float log2=0.693147181f;
+  const float tiny=std::numeric_limits<float>::min();
+
+  for(int h=0;h<n;h++){
+    const float x=xr[h];
+    const float ax=std::abs(x);
+
+    //exp(-2|x|) and tanh(x)
+    const float e=LnCoshExpNeg(-2.f*ax);
+    const float th=std::copysign((1.f-e)/(1.f+e),x);
+
+    float sy,cy;
+    LnCoshSinCos(xi[h],sy,cy);
+
+    const float tsy=th*sy;
+    const float mod2=std::max(cy*cy+tsy*tsy,tiny);
+
+    yr[h]=(ax-log2)+LnCoshLog(1.f+e)+0.5f*LnCoshLog(mod2);
+    yi[h]=LnCoshAtan2(tsy,cy);
+  }
+}
+
+//ln(cosh(x)) for real arguments
+//the real part of the complex kernel above for xi=0, where sin(xi)=0, cos(xi)=1
+//and ln(cos(xi)^2+tanh(xr)^2*sin(xi)^2)=0 exactly, so that the results coincide
+//bit by bit with the ones of the complex kernel
+NQS_LNCOSH_INLINE void LnCoshBatchRealPolyImpl(const double * __restrict__ xr,int n,double * __restrict__ yr){
+  const double log2=6.93147180559945286227e-01;
+
+  for(int h=0;h<n;h++){
+    const double ax=std::abs(xr[h]);
+    const double e=LnCoshExpNeg(-2.*ax);
+    yr[h]=(ax-log2)+LnCoshLog(1.+e);
+  }
+}
+
+NQS_LNCOSH_INLINE void LnCoshBatchRealPolyImpl(const float * __restrict__ xr,int n,float * __restrict__ yr){
+  const float log2=0.693147181f;
+
+  for(int h=0;h<n;h++){
+    const float ax=std::abs(xr[h]);
+    const float e=LnCoshExpNeg(-2.f*ax);
+    yr[h]=(ax-log2)+LnCoshLog(1.f+e);
+  }
+}
+
+inline void LnCoshBatchRealScalar(const double * xr,int n,double * yr){
+  const double log2=std::log(2.);
+
+  for(int h=0;h<n;h++){
+    const double xp=std::abs(xr[h]);
+    yr[h]=(xp<=12.)?std::log(std::cosh(xp)):(xp-log2);
+  }
+}
+
+inline void LnCoshBatchRealScalar(const float * xr,int n,float * yr){
+  const float log2=std::log(2.f);
+
+  for(int h=0;h<n;h++){
+    const float xp=std::abs(xr[h]);
+    yr[h]=(xp<=9.f)?std::log(std::cosh(xp)):(xp-log2);
+  }
+}
+
+//Variants of the polynomial kernel for the different instruction sets
+inline void LnCoshBatchPoly(const double * xr,const double * xi,int n,double * yr,double * yi){
+  LnCoshBatchPolyImpl(xr,xi,n,yr,yi);
+}
+
+inline void LnCoshBatchPoly(const float * xr,const float * xi,int n,float * yr,float * yi){
+  LnCoshBatchPolyImpl(xr,xi,n,yr,yi);
+}
+
+inline void LnCoshBatchRealPoly(const double * xr,int n,double * yr){
+  LnCoshBatchRealPolyImpl(xr,n,yr);
+}
+
+inline void LnCoshBatchRealPoly(const float * xr,int n,float * yr){
+  LnCoshBatchRealPolyImpl(xr,n,yr);
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define NQS_LNCOSH_DISPATCH
+
+__attribute__((target("avx2")))
+inline void LnCoshBatchPolyAvx2(const double * xr,const double * xi,int n,double * yr,double * yi){
+  LnCoshBatchPolyImpl(xr,xi,n,yr,yi);
+}
+
+__attribute__((target("avx512f")))
+inline void LnCoshBatchPolyAvx512(const double * xr,const double * xi,int n,double * yr,double * yi){
+  LnCoshBatchPolyImpl(xr,xi,n,yr,yi);
+}
+
+__attribute__((target("avx2")))
+inline void LnCoshBatchPolyAvx2(const float * xr,const float * xi,int n,float * yr,float * yi){
+  LnCoshBatchPolyImpl(xr,xi,n,yr,yi);
+}
+
+__attribute__((target("avx512f")))
+inline void LnCoshBatchPolyAvx512(const float * xr,const float * xi,int n,float * yr,float * yi){
+  LnCoshBatchPolyImpl(xr,xi,n,yr,yi);
+}
+
+__attribute__((target("avx2")))
+inline void LnCoshBatchRealPolyAvx2(const double * xr,int n,double * yr){
+  LnCoshBatchRealPolyImpl(xr,n,yr);
+}
+
+__attribute__((target("avx512f")))
+inline void LnCoshBatchRealPolyAvx512(const double * xr,int n,double * yr){
+  LnCoshBatchRealPolyImpl(xr,n,yr);
+}
+
+__attribute__((target("avx2")))
+inline void LnCoshBatchRealPolyAvx2(const float * xr,int n,float * yr){
+  LnCoshBatchRealPolyImpl(xr,n,yr);
+}
+
+__attribute__((target("avx512f")))
+inline void LnCoshBatchRealPolyAvx512(const float * xr,int n,float * yr){
+  LnCoshBatchRealPolyImpl(xr,n,yr);
+}
+#endif
+
+//Kernel type for real type T (double or float)
+template<class T> struct LnCoshBatchKernel{
+  typedef void (*type)(const T *,const T *,int,T *,T *);
+};
+
+//Kernel type for real arguments
+template<class T> struct LnCoshBatchRealKernel{
+  typedef void (*type)(const T *,int,T *);
+};
+
+//Chooses the kernel best suited to the running CPU
+template<class T> inline typename LnCoshBatchKernel<T>::type LnCoshSelectKernel(const char * & name){
+  typedef typename LnCoshBatchKernel<T>::type Kernel;
+#if defined(NQS_SCALAR_LNCOSH)
+  name="scalar";
+  return static_cast<Kernel>(LnCoshBatchScalar);
+#else
+#if defined(NQS_LNCOSH_DISPATCH)
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx512f")){
+    name="avx512";
+    return static_cast<Kernel>(LnCoshBatchPolyAvx512);
+  }
+  if(__builtin_cpu_supports("avx2")){
+    name="avx2";
+    return static_cast<Kernel>(LnCoshBatchPolyAvx2);
+  }
+#endif
+  name="generic";
+  return static_cast<Kernel>(LnCoshBatchPoly);
+#endif
+}
+
+//same as above, for real arguments
+template<class T> inline typename LnCoshBatchRealKernel<T>::type LnCoshSelectRealKernel(){
+  typedef typename LnCoshBatchRealKernel<T>::type Kernel;
+#if defined(NQS_SCALAR_LNCOSH)
+  return static_cast<Kernel>(LnCoshBatchRealScalar);
+#else
+#if defined(NQS_LNCOSH_DISPATCH)
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx512f")){
+    return static_cast<Kernel>(LnCoshBatchRealPolyAvx512);
+  }
+  if(__builtin_cpu_supports("avx2")){
+    return static_cast<Kernel>(LnCoshBatchRealPolyAvx2);
+  }
+#endif
+  return static_cast<Kernel>(LnCoshBatchRealPoly);
+#endif
+}
+
+//Name of the kernel used by LnCoshBatch
+inline const char * LnCoshKernelName(){
+  static const char * name=nullptr;
+  static const LnCoshBatchKernel<double>::type kernel=LnCoshSelectKernel<double>(name);
+  (void)kernel;
+  return name;
+}
+
+//ln(cosh(xr[h]+i*xi[h])) for h=0..n-1
+//the real and imaginary parts of the result are stored in yr and yi
+template<class T> inline void LnCoshBatch(const T * xr,const T * xi,int n,T * yr,T * yi){
+  static const char * name=nullptr;
+  static const typename LnCoshBatchKernel<T>::type kernel=LnCoshSelectKernel<T>(name);
+  kernel(xr,xi,n,yr,yi);
+}
+
+//ln(cosh(xr[h])) for h=0..n-1, real arguments
+//the results are equal to the real parts given by LnCoshBatch for xi=0
+template<class T> inline void LnCoshBatchReal(const T * xr,int n,T * yr){
+  static const typename LnCoshBatchRealKernel<T>::type kernel=LnCoshSelectRealKernel<T>();
+  kernel(xr,n,yr);
+}
@@ -0,0 +1,121 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include <vector>
+#include <complex>
+#include <cstdint>
+
+//Incremental evaluation of the logarithm of the wave-function on a sequence
+//of configurations, e.g. enumerated states or states read from a file
+//The look-up tables of the wave-function follow the sequence: going from a
+//configuration to the next only the rows of the weights corresponding to the
+//spins that differ are added, so that the cost per configuration is
+//O(nhidden*ndiff) instead of O(nhidden*nspins)
+//The evaluator owns a copy of the wave-function, leaving the look-up tables
+//of the original one untouched
+template<class Wf> class LogValEvaluator{
+
+  //copy of the wave-function, its look-up tables follow the sequence
+  Wf wf_;
+
+  //number of spins
+  const int nspins_;
+
+  //current configuration
+  std::vector<int> state_;
+  SpinConfig config_;
+
+  //sites that differ from the current configuration
+  std::vector<int> flips_;
+
+  //true once the look-up tables have been initialized
+  bool init_;
+
+  //number of flips accumulated since the last initialization
+  //the tables are recomputed from scratch once it exceeds resyncflips_
+  //to avoid the accumulation of rounding errors
+  long long nflips_;
+  long long resyncflips_;
+
+public:
+
+  LogValEvaluator(const Wf & wf):wf_(wf),nspins_(wf.Nspins()),init_(false),nflips_(0){
+    state_.resize(nspins_);
+    config_.Resize(nspins_);
+    flips_.reserve(nspins_);
+    resyncflips_=1024*(long long)(nspins_);
+  }
+
+  //logarithm of the wave-function on the given configuration
+  std::complex<double> LogVal(const SpinConfig & config){
+
+    if(config.Nspins()!=nspins_){
+      std::cerr<<"# Error : The configuration and the wave-function have a different number of spins"<<std::endl;
+      std::abort();
+    }
+
+    flips_.clear();
+    for(int k=0;k<config.NWords();k++){
+      ForEachBit(config.Word(k)^config_.Word(k),64*k,[this](int i){
+        flips_.push_back(i);
+      });
+    }
+
+    nflips_+=flips_.size();
+
+    if(!init_ || nflips_>resyncflips_){
+      config_=config;
+      config_.Get(state_);
+      wf_.InitLt(state_);
+      init_=true;
+      nflips_=0;
+    }
+    else if(flips_.size()>0){
+      wf_.UpdateLt(state_,flips_.data(),flips_.size());
+      for(const auto & flip : flips_){
+        state_[flip]*=-1;
+        config_.Flip(flip);
+      }
+    }
+
+    return wf_.LogValLt(state_);
+  }
+
+  //logarithm of the wave-function on all the given configurations,
+  //visited in the given order
+  //consecutive configurations differing by few spins are evaluated faster
+  void LogVals(const std::vector<SpinConfig> & configs,std::vector<std::complex<double> > & logvals){
+    logvals.resize(configs.size());
+    for(std::size_t i=0;i<configs.size();i++){
+      logvals[i]=LogVal(configs[i]);
+    }
+  }
+
+  //forces the initialization of the look-up tables at the next evaluation
+  void Reset(){
+    init_=false;
+  }
+
+};
@@ -31,11 +31,31 @@ All use of these programs is entirely at the user's own risk.
 #include <complex>
 #include <fstream>
 #include <cassert>
-
-class Nqs{
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+
+//Neural-network quantum state, templated on the scalar type T of the weights,
+//of the look-up tables and of the angles theta
+//T=double is the reference implementation, T=float is the mixed-precision
+//mode: angles and ln(cosh) are stored and updated in single precision while
+//the biases, all the sums over visible and hidden units and the values
+//returned (logarithms of amplitudes and ratios) stay in double precision
+//NV and NH, when positive, fix at compile time the numbers of visible and
+//hidden units, so that the loops over the units have constant trip counts
+//(see the dispatch table in main.cc), 0 leaves them to the loaded file
+template<class T,int NV=0,int NH=0> class NqsT{
 
   //Neural-network weights
-  std::vector<std::vector<std::complex<double> > > W_;
+  //stored as contiguous real and imaginary planes, W(v,h) being at v*nhs_+h
+  //the hidden-unit index runs fastest so that loops over hidden units vectorize
+  const T * Wr_;
+  const T * Wi_;
+
+  //Storage of the weights, shared among copies of the wave-function
+  //it is either an aligned buffer (text files, or any file when T is not
+  //double) or a memory-mapped binary file
+  std::shared_ptr<const void> Wstorage_;
 
   //Neural-network visible bias
   std::vector<std::complex<double> > a_;
@@ -49,16 +69,93 @@ class Nqs{
   //Number of visible units
   int nv_;
 
-  //look-up tables
-  std::vector<std::complex<double> > Lt_;
+  //Stride between rows of the weight planes
+  //nh_ rounded up to a whole number of cache lines
+  int nhs_;
+
+  //look-up tables (real and imaginary parts of the angles theta)
+  AlignedVector<T> Ltr_;
+  AlignedVector<T> Lti_;
+
+  //look-up tables for ln(cosh(theta)), kept in sync with Ltr_ and Lti_
+  AlignedVector<T> Lcr_;
+  AlignedVector<T> Lci_;
+
+  //Work space for the angles of the proposed states
+  mutable AlignedVector<T> thr_;
+  mutable AlignedVector<T> thi_;
+
+  //Work space for ln(cosh(theta))
+  mutable AlignedVector<T> lcpr_;
+  mutable AlignedVector<T> lcpi_;
+
+  //Work space for the batched computation of Psi(state')/Psi(state)
+  mutable std::vector<std::complex<double> > logpops_;
+
+  //Spin flips of the last single-state LogPoP, whose angles and ln(cosh)
+  //are still in the work space: if the move is accepted UpdateLt swaps
+  //them into the look-up tables instead of recomputing them
+  //lastnflips_<0 when the work space has been overwritten
+  mutable int lastflips_[4];
+  mutable int lastnflips_;
+
+  //The look-up tables are recomputed from scratch every resyncinterval_
+  //updates, so that the rounding errors of the incremental updates do not
+  //accumulate along the chain (0 never recomputes them)
+  int resyncinterval_;
+  int nupdates_;
+  std::vector<int> resyncstate_;
+
+  //True when all the parameters have vanishing imaginary part
+  //the angles are then real, the imaginary planes of the look-up tables
+  //stay zero and are never updated, and ln(cosh) is evaluated for real
+  //arguments only, giving the same results as the complex path
+  bool real_;
+
+  //hash of the parameters (see ParameterHash)
+  mutable bool hashed_;
+  mutable std::uint64_t hash_;
+
+  //Number of hidden units processed together in the batched PoP
+  //256 hidden units of 100 visible units take 400kB of weights
+  static const int hblock_=256;
 
   //Useful quantities for safe computation of ln(cosh(x))
   const double log2_;
 
 public:
 
-  Nqs(std::string filename):log2_(std::log(2.)){
-    LoadParameters(filename);
+  //verbose=false suppresses the messages printed on standard output
+  NqsT(std::string filename,bool verbose=true):lastnflips_(-1),nupdates_(0),hashed_(false),hash_(0),log2_(std::log(2.)){
+    LoadParameters(filename,verbose);
+
+    if((NV>0 && nv_!=NV) || (NH>0 && nh_!=NH)){
+      std::cerr<<"# Error : the wave-function in file "<<filename<<" has "<<nv_<<" visible and "<<nh_;
+      std::cerr<<" hidden units, instead of "<<NV<<" and "<<NH<<std::endl;
+      std::abort();
+    }
+
+    //in single precision the updates drift by about 1e-7 per flip
+    resyncinterval_=std::is_same<T,double>::value?0:16*nv_;
+  }
+
+  //sets the number of updates of the look-up tables between two
+  //recomputations from scratch, 0 disables them
+  void SetResyncInterval(int resyncinterval){
+    resyncinterval_=resyncinterval;
+  }
+
+  //numbers of units, and row stride of the weights
+  inline int Nv()const{
+    return (NV>0)?NV:nv_;
+  }
+
+  inline int Nh()const{
+    return (NH>0)?NH:nh_;
+  }
+
+  inline int Nhs()const{
+    return (NH>0)?int(WfBinaryPad(NH)):nhs_;
   }
 
   //computes the logarithm of the wave-function
@@ -66,50 +163,109 @@ public:
 
     std::complex<double> rbm(0.,0.);
 
-    for(int v=0;v<nv_;v++){
+    for(int v=0;v<Nv();v++){
       rbm+=a_[v]*double(state[v]);
     }
 
-    for(int h=0;h<nh_;h++){
+    T * __restrict__ thr=thr_.data();
+    T * __restrict__ thi=thi_.data();
+
+    for(int h=0;h<Nh();h++){
+      thr[h]=b_[h].real();
+      thi[h]=b_[h].imag();
+    }
+
+    AddState(thr,thi,state);
 
-      std::complex<double> thetah=b_[h];
+    LnCosh(thr,thi,Nh(),lcpr_.data(),lcpi_.data());
+    lastnflips_=-1;
 
-      for(int v=0;v<nv_;v++){
-        thetah+=double(state[v])*(W_[v][h]);
+    if(real_){
+      double rbmr=rbm.real();
+      for(int h=0;h<Nh();h++){
+        rbmr+=lcpr_[h];
       }
+      return std::complex<double>(rbmr,rbm.imag());
+    }
 
-      rbm+=Nqs::lncosh(thetah);
+    for(int h=0;h<Nh();h++){
+      rbm+=std::complex<double>(lcpr_[h],lcpi_[h]);
     }
 
     return rbm;
   }
 
+  //computes the logarithm of the wave-function from the look-up tables,
+  //which must be initialized (or updated) on the given state
+  inline std::complex<double> LogValLt(const std::vector<int> & state)const{
+
+    std::complex<double> rbm(0.,0.);
+
+    for(int v=0;v<Nv();v++){
+      rbm+=a_[v]*double(state[v]);
+    }
+
+    double lcr=0;
+    double lci=0;
+    for(int h=0;h<Nh();h++){
+      lcr+=Lcr_[h];
+      lci+=Lci_[h];
+    }
+
+    return rbm+std::complex<double>(lcr,lci);
+  }
+
   //computes the logarithm of Psi(state')/Psi(state)
   //where state' is a state with a certain number of flipped spins
   //the vector "flips" contains the sites to be flipped
   //look-up tables are used to speed-up the calculation
   inline std::complex<double> LogPoP(const std::vector<int> & state,const std::vector<int> & flips)const{
+    return LogPoP(state,flips.data(),flips.size());
+  }
 
-    if(flips.size()==0){
+  //same as above, the sites to be flipped being flips[0] ... flips[nflips-1]
+  inline std::complex<double> LogPoP(const std::vector<int> & state,const int * flips,int nflips)const{
+
+    if(nflips==0){
       return 0.;
     }
 
     std::complex<double> logpop(0.,0.);
 
     //Change due to the visible bias
-    for(const auto & flip : flips){
-      logpop-=a_[flip]*2.*double(state[flip]);
+    for(int f=0;f<nflips;f++){
+      logpop-=a_[flips[f]]*2.*double(state[flips[f]]);
     }
 
     //Change due to the interaction weights
-    for(int h=0;h<nh_;h++){
-      const std::complex<double> thetah=Lt_[h];
-      std::complex<double> thetahp=thetah;
+    T * __restrict__ thr=thr_.data();
+    T * __restrict__ thi=thi_.data();
+
+    std::copy(Ltr_.begin(),Ltr_.end(),thr_.begin());
+    if(!real_){
+      std::copy(Lti_.begin(),Lti_.end(),thi_.begin());
+    }
 
-      for(const auto & flip : flips){
-        thetahp-=2.*double(state[flip])*(W_[flip][h]);
+    AddFlips(thr,thi,state,flips,nflips,0,Nh());
+
+    //ln(cosh(theta)) for the current state is taken from the look-up tables
+    LnCosh(thr,thi,Nh(),lcpr_.data(),lcpi_.data());
+
+    lastnflips_=(nflips<=4)?nflips:-1;
+    for(int f=0;f<nflips && f<4;f++){
+      lastflips_[f]=flips[f];
+    }
+
+    if(real_){
+      double logpopr=logpop.real();
+      for(int h=0;h<Nh();h++){
+        logpopr+=lcpr_[h]-Lcr_[h];
       }
-      logpop+= ( Nqs::lncosh(thetahp)-Nqs::lncosh(thetah) );
+      return std::complex<double>(logpopr,logpop.imag());
+    }
+
+    for(int h=0;h<Nh();h++){
+      logpop+=std::complex<double>(lcpr_[h]-Lcr_[h],lcpi_[h]-Lci_[h]);
     }
 
     return logpop;
@@ -119,35 +275,373 @@ public:
     return std::exp(LogPoP(state,flips));
   }
 
+  inline std::complex<double> PoP(const std::vector<int> & state,const int * flips,int nflips)const{
+    return std::exp(LogPoP(state,flips,nflips));
+  }
+
+  //computes Psi(state')/Psi(state) for all the connected states state'
+  //contained in conn (see connbuffer.cc)
+  //all the ratios are computed in a single pass over blocks of hidden units,
+  //so that the rows of the weights needed by all the states stay in cache
+  void PoP(const std::vector<int> & state,const ConnBuffer & conn,std::vector<std::complex<double> > & pop)const{
+
+    const int nconn=conn.Size();
+
+    logpops_.assign(nconn,0.);
+
+    //Change due to the visible bias
+    for(int i=0;i<nconn;i++){
+      const int * flips=conn.Flips(i);
+      for(int f=0;f<conn.NFlips(i);f++){
+        logpops_[i]-=a_[flips[f]]*2.*double(state[flips[f]]);
+      }
+    }
+
+    //Change due to the interaction weights, block by block
+    T * __restrict__ thr=thr_.data();
+    T * __restrict__ thi=thi_.data();
+
+    for(int h0=0;h0<Nh();h0+=hblock_){
+      const int nb=(Nh()-h0<hblock_)?(Nh()-h0):hblock_;
+
+      for(int i=0;i<nconn;i++){
+        const int * flips=conn.Flips(i);
+        const int nflips=conn.NFlips(i);
+
+        if(nflips==0){
+          continue;
+        }
+
+        std::copy(Ltr_.begin()+h0,Ltr_.begin()+h0+nb,thr_.begin());
+        if(!real_){
+          std::copy(Lti_.begin()+h0,Lti_.begin()+h0+nb,thi_.begin());
+        }
+
+        AddFlips(thr,thi,state,flips,nflips,h0,nb);
+
+        LnCosh(thr,thi,nb,lcpr_.data(),lcpi_.data());
+
+        if(real_){
+          double logpopr=0.;
+          for(int h=0;h<nb;h++){
+            logpopr+=lcpr_[h]-Lcr_[h0+h];
+          }
+          logpops_[i]+=logpopr;
+          continue;
+        }
+
+        std::complex<double> logpop(0.,0.);
+        for(int h=0;h<nb;h++){
+          logpop+=std::complex<double>(lcpr_[h]-Lcr_[h0+h],lcpi_[h]-Lci_[h0+h]);
+        }
+        logpops_[i]+=logpop;
+      }
+    }
+
+    lastnflips_=-1;
+
+    pop.resize(nconn);
+    for(int i=0;i<nconn;i++){
+      pop[i]=std::exp(logpops_[i]);
+    }
+  }
+
   //initialization of the look-up tables
   void InitLt(const std::vector<int> & state){
-    Lt_.resize(nh_);
 
-    for(int h=0;h<nh_;h++){
-      Lt_[h]=b_[h];
-      for(int v=0;v<nv_;v++){
-        Lt_[h]+=double(state[v])*(W_[v][h]);
-      }
+    for(int h=0;h<Nh();h++){
+      Ltr_[h]=b_[h].real();
+      Lti_[h]=b_[h].imag();
     }
 
+    AddState(Ltr_.data(),Lti_.data(),state);
+
+    LnCosh(Ltr_.data(),Lti_.data(),Nh(),Lcr_.data(),Lci_.data());
+    lastnflips_=-1;
+    nupdates_=0;
+  }
+
+  //identity of the wave-function for checkpoints: sizes, precision and a
+  //hash of the parameters, so that a checkpoint is not resumed with a
+  //different wave-function
+  void SaveId(CheckpointWriter & out)const{
+    out.Put(std::int64_t(nv_));
+    out.Put(std::int64_t(nh_));
+    out.Put(std::int64_t(sizeof(T)));
+    out.Put(ParameterHash());
+  }
+
+  void CheckId(CheckpointReader & in)const{
+    std::int64_t nv,nh,size;
+    std::uint64_t hash;
+    in.Get(nv);
+    in.Get(nh);
+    in.Get(size);
+    in.Get(hash);
+    if(nv!=nv_ || nh!=nh_){
+      in.Fail("the wave-function has a different number of units");
+    }
+    if(size!=std::int64_t(sizeof(T))){
+      in.Fail("the wave-function was evaluated with a different precision");
+    }
+    if(hash!=ParameterHash()){
+      in.Fail("the parameters of the wave-function are different");
+    }
+  }
+
+  //hash of all the parameters, computed on first use
+  std::uint64_t ParameterHash()const{
+    if(!hashed_){
+      const std::size_t nw=std::size_t(nv_)*nhs_*sizeof(T);
+      hash_=WfBinaryChecksum(a_.data(),a_.size()*sizeof(a_[0]));
+      hash_=hash_*1099511628211ULL^WfBinaryChecksum(b_.data(),b_.size()*sizeof(b_[0]));
+      hash_=hash_*1099511628211ULL^WfBinaryChecksum(Wr_,nw);
+      hash_=hash_*1099511628211ULL^WfBinaryChecksum(Wi_,nw);
+      hashed_=true;
+    }
+    return hash_;
+  }
+
+  //binary image of the look-up tables for checkpoints (see checkpoint.cc)
+  //restoring the tables, rather than recomputing them, keeps the
+  //rounding errors accumulated by the updates
+  void SaveLt(CheckpointWriter & out)const{
+    out.Put(std::int64_t(nv_));
+    out.Put(std::int64_t(nh_));
+    out.Put(std::int64_t(sizeof(T)));
+    out.Put(Ltr_);
+    out.Put(Lti_);
+  }
+
+  void LoadLt(CheckpointReader & in){
+    std::int64_t nv,nh,size;
+    in.Get(nv);
+    in.Get(nh);
+    in.Get(size);
+    if(nv!=nv_ || nh!=nh_){
+      in.Fail("the look-up tables do not match the wave-function");
+    }
+    if(size!=std::int64_t(sizeof(T))){
+      in.Fail("the look-up tables were saved with a different precision");
+    }
+    in.Get(Ltr_);
+    in.Get(Lti_);
+    if(Ltr_.size()!=Lcr_.size() || Lti_.size()!=Lcr_.size()){
+      in.Fail("invalid look-up tables");
+    }
+    LnCosh(Ltr_.data(),Lti_.data(),Nh(),Lcr_.data(),Lci_.data());
+    lastnflips_=-1;
+    nupdates_=0;
   }
 
   //updates the look-up tables after spin flips
   //the vector "flips" contains the indices of sites to be flipped
   void UpdateLt(const std::vector<int> & state,const std::vector<int> & flips){
-    if(flips.size()==0){
+    UpdateLt(state,flips.data(),flips.size());
+  }
+
+  //if the flips are the ones of the last call to LogPoP (accepted move)
+  //the angles and ln(cosh) already computed there are swapped in, otherwise
+  //all the rows of the flipped spins are added in a single pass
+  void UpdateLt(const std::vector<int> & state,const int * flips,int nflips){
+    if(nflips==0){
+      return;
+    }
+
+    if(resyncinterval_>0 && ++nupdates_>=resyncinterval_){
+      Resync(state,flips,nflips);
+      return;
+    }
+
+    if(IsLastPoP(flips,nflips)){
+      Ltr_.swap(thr_);
+      Lti_.swap(thi_);
+      Lcr_.swap(lcpr_);
+      Lci_.swap(lcpi_);
+      lastnflips_=-1;
       return;
     }
 
-    for(int h=0;h<nh_;h++){
-      for(const auto & flip : flips){
-        Lt_[h]-=2.*double(state[flip])*W_[flip][h];
+    AddFlips(Ltr_.data(),Lti_.data(),state,flips,nflips,0,Nh());
+
+    LnCosh(Ltr_.data(),Lti_.data(),Nh(),Lcr_.data(),Lci_.data());
+    lastnflips_=-1;
+  }
+
+  //recomputes the look-up tables from scratch on the state after the flips
+  void Resync(const std::vector<int> & state,const int * flips,int nflips){
+    resyncstate_=state;
+    for(int f=0;f<nflips;f++){
+      resyncstate_[flips[f]]=-resyncstate_[flips[f]];
+    }
+    InitLt(resyncstate_);
+  }
+
+  inline bool IsLastPoP(const int * flips,int nflips)const{
+    if(nflips!=lastnflips_){
+      return false;
+    }
+    for(int f=0;f<nflips;f++){
+      if(flips[f]!=lastflips_[f]){
+        return false;
       }
     }
+    return true;
+  }
+
+  //adds sum_r c[r]*W(v[r],h) to the angles (thr[h],thi[h]) of the nb hidden
+  //units starting from h0 (thr[0] and thi[0] correspond to the hidden unit h0)
+  //K rows are added in a single pass over the hidden units, in order, so that
+  //the result does not depend on how the rows are grouped
+  //this is the elementary operation on which all the updates of theta are built
+  template<int K> inline void AddRows(T * __restrict__ thr,T * __restrict__ thi,
+    const int * v,const T * c,int h0,int nb)const{
+
+    const T * __restrict__ wr[K];
+    const T * __restrict__ wi[K];
+    for(int r=0;r<K;r++){
+      wr[r]=Wr_+std::size_t(v[r])*Nhs()+h0;
+      wi[r]=Wi_+std::size_t(v[r])*Nhs()+h0;
+    }
+
+    if(real_){
+      for(int h=0;h<nb;h++){
+        T tr=thr[h];
+        for(int r=0;r<K;r++){
+          tr+=c[r]*wr[r][h];
+        }
+        thr[h]=tr;
+      }
+      return;
+    }
+
+    for(int h=0;h<nb;h++){
+      T tr=thr[h];
+      T ti=thi[h];
+      for(int r=0;r<K;r++){
+        tr+=c[r]*wr[r][h];
+        ti+=c[r]*wi[r][h];
+      }
+      thr[h]=tr;
+      thi[h]=ti;
+    }
+  }
+
+  //ln(cosh(theta)) for n angles
+  inline void LnCosh(const T * thr,const T * thi,int n,T * yr,T * yi)const{
+    if(real_){
+      LnCoshBatchReal(thr,n,yr);
+    }
+    else{
+      LnCoshBatch(thr,thi,n,yr,yi);
+    }
+  }
+
+  //rank-k update of the angles, k rows v[0]...v[k-1] with coefficients c
+  //rows are processed in groups of 4
+  inline void AddRows(T * __restrict__ thr,T * __restrict__ thi,
+    const int * v,const T * c,int k,int h0,int nb)const{
+
+    int r=0;
+    for(;r+4<=k;r+=4){
+      AddRows<4>(thr,thi,v+r,c+r,h0,nb);
+    }
+    switch(k-r){
+      case 3:
+        AddRows<3>(thr,thi,v+r,c+r,h0,nb);
+        break;
+      case 2:
+        AddRows<2>(thr,thi,v+r,c+r,h0,nb);
+        break;
+      case 1:
+        AddRows<1>(thr,thi,v+r,c+r,h0,nb);
+        break;
+    }
+  }
+
+  //changes of the angles due to the given spin flips
+  inline void AddFlips(T * __restrict__ thr,T * __restrict__ thi,
+    const std::vector<int> & state,const int * flips,int nflips,int h0,int nb)const{
+
+    T c[4];
+    for(int f0=0;f0<nflips;f0+=4){
+      const int k=(nflips-f0<4)?(nflips-f0):4;
+      for(int f=0;f<k;f++){
+        c[f]=T(-2*state[flips[f0+f]]);
+      }
+      AddRows(thr,thi,flips+f0,c,k,h0,nb);
+    }
+  }
+
+  //contributions to the angles of all the visible units in the given state
+  inline void AddState(T * __restrict__ thr,T * __restrict__ thi,const std::vector<int> & state)const{
+    int v[4];
+    T c[4];
+    for(int v0=0;v0<Nv();v0+=4){
+      const int k=(Nv()-v0<4)?(Nv()-v0):4;
+      for(int r=0;r<k;r++){
+        v[r]=v0+r;
+        c[r]=T(state[v0+r]);
+      }
+      AddRows(thr,thi,v,c,k,0,Nh());
+    }
   }
 
   //loads the parameters of the wave-function from a given file
-  void LoadParameters(std::string filename){
+  //the format (text or binary) is detected automatically
+  void LoadParameters(std::string filename,bool verbose=true){
+
+    if(IsWfBinary(filename)){
+      LoadBinaryParameters(filename);
+    }
+    else{
+      LoadTextParameters(filename);
+      real_=IsReal();
+    }
+
+    Ltr_.assign(nhs_,0.);
+    Lti_.assign(nhs_,0.);
+    Lcr_.assign(nhs_,0.);
+    Lci_.assign(nhs_,0.);
+    thr_.assign(nhs_,0.);
+    thi_.assign(nhs_,0.);
+    lcpr_.assign(nhs_,0.);
+    lcpi_.assign(nhs_,0.);
+
+    if(!verbose){
+      return;
+    }
+
+    std::cout<<"# NQS loaded from file "<<filename<<std::endl;
+    std::cout<<"# N_visible = "<<nv_<<"  N_hidden = "<<nh_<<std::endl;
+    if(real_){
+      std::cout<<"# All the parameters are real"<<std::endl;
+    }
+  }
+
+  //checks whether all the parameters have vanishing imaginary part
+  //it reads all the weights, binary files store the answer in their header
+  bool IsReal()const{
+    for(int i=0;i<nv_;i++){
+      if(a_[i].imag()!=0){
+        return false;
+      }
+    }
+    for(int j=0;j<nh_;j++){
+      if(b_[j].imag()!=0){
+        return false;
+      }
+    }
+    for(std::size_t k=0;k<std::size_t(nv_)*nhs_;k++){
+      if(Wi_[k]!=0){
+        return false;
+      }
+    }
+    return true;
+  }
+
+  //loads the parameters from a text file
+  void LoadTextParameters(std::string filename){
 
     std::ifstream fin(filename.c_str());
 
@@ -165,9 +659,15 @@ public:
       std::abort();
     }
 
+    //rows are padded to a multiple of 8 doubles (64 bytes)
+    nhs_=WfBinaryPad(nh_);
+
     a_.resize(nv_);
     b_.resize(nh_);
-    W_.resize(nv_,std::vector<std::complex<double> > (nh_));
+
+    std::shared_ptr<AlignedVector<T> > W(new AlignedVector<T>(2*std::size_t(nv_)*nhs_,0.));
+    T * Wr=W->data();
+    T * Wi=W->data()+std::size_t(nv_)*nhs_;
 
     for(int i=0;i<nv_;i++){
       fin>>a_[i];
@@ -177,7 +677,10 @@ public:
     }
     for(int i=0;i<nv_;i++){
       for(int j=0;j<nh_;j++){
-        fin>>W_[i][j];
+        std::complex<double> w;
+        fin>>w;
+        Wr[std::size_t(i)*nhs_+j]=T(w.real());
+        Wi[std::size_t(i)*nhs_+j]=T(w.imag());
       }
     }
 
@@ -187,8 +690,94 @@ public:
       std::abort();
     }
 
-    std::cout<<"# NQS loaded from file "<<filename<<std::endl;
-    std::cout<<"# N_visible = "<<nv_<<"  N_hidden = "<<nh_<<std::endl;
+    Wr_=Wr;
+    Wi_=Wi;
+    Wstorage_=W;
+  }
+
+  //maps the parameters from a binary file (see wfbinary.cc)
+  //in double precision the weights are used in place, without copies,
+  //otherwise they are converted to T once
+  //whether the parameters are real is read from the header, so that the
+  //imaginary planes are not read in (files of version 1 are scanned)
+  void LoadBinaryParameters(std::string filename){
+
+    WfBinaryHeader header;
+    std::shared_ptr<const char> map=WfBinaryMap(filename,header);
+
+    nv_=header.nv;
+    nh_=header.nh;
+    nhs_=WfBinaryPad(nh_);
+    const std::size_t nvs=WfBinaryPad(nv_);
+
+    const double * p=reinterpret_cast<const double *>(map.get()+sizeof(WfBinaryHeader));
+
+    a_.resize(nv_);
+    b_.resize(nh_);
+
+    for(int i=0;i<nv_;i++){
+      a_[i]=std::complex<double>(p[i],p[nvs+i]);
+    }
+    p+=2*nvs;
+
+    for(int j=0;j<nh_;j++){
+      b_[j]=std::complex<double>(p[j],p[nhs_+j]);
+    }
+    p+=2*nhs_;
+
+    UseWeights(p,map);
+
+    if(header.version>1){
+      real_=bool(header.flags&WfBinaryReal);
+    }
+    else{
+      real_=IsReal();
+    }
+  }
+
+  //weights stored in the binary file (see LoadBinaryParameters)
+  void UseWeights(const double * p,const std::shared_ptr<const char> & map){
+    if(std::is_same<T,double>::value){
+      Wr_=reinterpret_cast<const T *>(p);
+      Wi_=reinterpret_cast<const T *>(p+std::size_t(nv_)*nhs_);
+      Wstorage_=map;
+      return;
+    }
+
+    const std::size_t nw=2*std::size_t(nv_)*nhs_;
+    std::shared_ptr<AlignedVector<T> > W(new AlignedVector<T>(nw));
+    for(std::size_t i=0;i<nw;i++){
+      (*W)[i]=T(p[i]);
+    }
+    Wr_=W->data();
+    Wi_=W->data()+std::size_t(nv_)*nhs_;
+    Wstorage_=W;
+  }
+
+  //saves the parameters to a file in binary format (see wfbinary.cc)
+  void SaveBinaryParameters(std::string filename)const{
+
+    const std::size_t nvs=WfBinaryPad(nv_);
+
+    std::vector<double> payload(2*nvs+2*nhs_+2*std::size_t(nv_)*nhs_,0.);
+    double * p=payload.data();
+
+    for(int i=0;i<nv_;i++){
+      p[i]=a_[i].real();
+      p[nvs+i]=a_[i].imag();
+    }
+    p+=2*nvs;
+
+    for(int j=0;j<nh_;j++){
+      p[j]=b_[j].real();
+      p[nhs_+j]=b_[j].imag();
+    }
+    p+=2*nhs_;
+
+    std::copy(Wr_,Wr_+std::size_t(nv_)*nhs_,p);
+    std::copy(Wi_,Wi_+std::size_t(nv_)*nhs_,p+std::size_t(nv_)*nhs_);
+
+    WfBinaryWrite(filename,nv_,nh_,payload,real_);
   }
 
   //ln(cos(x)) for real argument
@@ -210,7 +799,7 @@ public:
     const double xr=x.real();
     const double xi=x.imag();
 
-    std::complex<double> res=Nqs::lncosh(xr);
+    std::complex<double> res=NqsT::lncosh(xr);
     res +=std::log( std::complex<double>(std::cos(xi),std::tanh(xr)*std::sin(xi)) );
 
     return res;
@@ -219,7 +808,34 @@ public:
   //total number of spins
   //equal to the number of visible units
   inline int Nspins()const{
-    return nv_;
+    return Nv();
   }
 
 };
+
+//numbers of visible and hidden units of the wave-function in a file,
+//read without loading the parameters
+//returns false if the file cannot be read
+inline bool NqsSizes(std::string filename,int & nv,int & nh){
+  std::ifstream fin(filename.c_str(),std::ios::binary);
+
+  if(IsWfBinary(filename)){
+    WfBinaryHeader header;
+    if(!fin.read(reinterpret_cast<char *>(&header),sizeof(header))){
+      return false;
+    }
+    nv=header.nv;
+    nh=header.nh;
+    return true;
+  }
+
+  fin>>nv;
+  fin>>nh;
+  return fin.good();
+}
+
+//the reference double-precision wave-function
+typedef NqsT<double> Nqs;
+
+//mixed-precision wave-function (see NqsT)
+typedef NqsT<float> NqsMixed;
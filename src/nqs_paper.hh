@@ -25,8 +25,23 @@ All use of these programs is entirely at the user's own risk.
 
 #include <string>
 #include "readoptions.cc"
+#include "alignedallocator.cc"
+#include "lncosh.cc"
+#include "wfbinary.cc"
+#include "connbuffer.cc"
+#include "spinconfig.cc"
+#include "statesfile.cc"
+#include "checkpoint.cc"
+#include "binning.cc"
+#include "rng.cc"
+#include "profile.cc"
 #include "nqs.cc"
+#include "logvalevaluator.cc"
 #include "ising1d.cc"
 #include "heisenberg1d.cc"
 #include "heisenberg2d.cc"
 #include "sampler.cc"
+#include "parallelsampler.cc"
+#include "replicasampler.cc"
+#include "exactengine.cc"
+#include "batchrunner.cc"
@@ -0,0 +1,193 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <ctime>
+
+//Monte Carlo sampling with several independent Markov chains
+//Each chain owns a copy of the wave-function (hence its own look-up tables),
+//its own state and its own random number stream.
+//Chains are distributed over a pool of threads and their measurements are
+//merged at the end of the run
+template<class Wf,class Hamiltonian,class Rng=StdRng> class ParallelSampler{
+
+  typedef Sampler<Wf,Hamiltonian,Rng> ChainSampler;
+
+  //number of independent Markov chains
+  const int nchains_;
+
+  //number of threads used to run the chains
+  const int nthreads_;
+
+  //copies of the wave-function, one per chain
+  std::vector<Wf> wfs_;
+
+  //samplers, one per chain
+  std::vector<std::unique_ptr<ChainSampler> > samplers_;
+
+public:
+
+  ParallelSampler(const Wf & wf,Hamiltonian & hamiltonian,int seed,int nchains,int nthreads):
+    nchains_(nchains),nthreads_(std::min(nthreads,nchains)),wfs_(nchains,wf){
+
+    if(nchains_<1 || nthreads_<1){
+      std::cerr<<"# Error : The number of chains and threads should be positive integers"<<std::endl;
+      std::abort();
+    }
+
+    //every chain uses a different stream of the random number policy
+    //seed<0 sets the base seed to the internal clock value
+    const int baseseed=(seed<0)?int(std::time(nullptr)):seed;
+
+    for(int c=0;c<nchains_;c++){
+      samplers_.push_back(std::unique_ptr<ChainSampler>(new ChainSampler(wfs_[c],hamiltonian,baseseed,c)));
+      samplers_[c]->SetVerbose(false);
+    }
+  }
+
+  //sets the target statistical error on the energy per spin
+  //every chain stops when its own error is below targeterror*sqrt(nchains),
+  //so that the merged error is approximately targeterror
+  void SetTargetError(double targeterror){
+    for(int c=0;c<nchains_;c++){
+      samplers_[c]->SetTargetError(targeterror*std::sqrt(double(nchains_)));
+    }
+  }
+
+  void SetBatchedProposals(bool batched){
+    for(int c=0;c<nchains_;c++){
+      samplers_[c]->SetBatchedProposals(batched);
+    }
+  }
+
+  void SetLocalMoves(double localratio){
+    for(int c=0;c<nchains_;c++){
+      samplers_[c]->SetLocalMoves(localratio);
+    }
+  }
+
+  //each chain saves its checkpoints on a separate file FILENAME.CHAIN
+  //when more than one chain is used
+  void SetCheckpoint(std::string filename,double interval){
+    for(int c=0;c<nchains_;c++){
+      samplers_[c]->SetCheckpoint(ChainFile(filename,c),interval);
+    }
+  }
+
+  void SetWarmStart(std::string filename){
+    for(int c=0;c<nchains_;c++){
+      samplers_[c]->SetWarmStart(ChainFile(filename,c));
+    }
+  }
+
+  //each chain writes its sampled configurations on a separate file
+  //FILENAME.CHAIN when more than one chain is used
+  void SetFileStates(std::string filename,bool binary=false){
+    if(nchains_==1){
+      samplers_[0]->SetFileStates(filename,binary);
+      return;
+    }
+    for(int c=0;c<nchains_;c++){
+      samplers_[c]->SetFileStates(filename+"."+std::to_string(c),binary);
+    }
+    std::cout<<"# Saving sampled configurations to files "<<filename<<".CHAIN";
+    std::cout<<(binary?" (binary format)":"")<<std::endl;
+  }
+
+  //each chain writes its measured energies on a separate file
+  //FILENAME.CHAIN when more than one chain is used
+  void SetFileEnergies(std::string filename){
+    if(nchains_==1){
+      samplers_[0]->SetFileEnergies(filename);
+      return;
+    }
+    for(int c=0;c<nchains_;c++){
+      samplers_[c]->SetFileEnergies(filename+"."+std::to_string(c));
+    }
+    std::cout<<"# Saving measured energies to files "<<filename<<".CHAIN"<<std::endl;
+  }
+
+  //the profiles of all the chains are merged and written by the first one
+  void SetFileProfile(std::string filename){
+    samplers_[0]->SetFileProfile(filename);
+  }
+
+  //name of the file of chain c
+  std::string ChainFile(std::string filename,int c)const{
+    return (nchains_==1)?filename:(filename+"."+std::to_string(c));
+  }
+
+  //Run the Monte Carlo sampling
+  //nsweeps is the total number of sweeps to be done, split among the chains
+  //every chain is thermalized for nsweeps*thermfactor sweeps
+  //the other parameters have the same meaning as in Sampler::Run
+  void Run(double nsweeps,double thermfactor=0.1,int sweepfactor=1,int nflipss=-1){
+
+    const int nflips=samplers_[0]->CheckInput(nsweeps,thermfactor,nflipss);
+
+    const double nsweepschain=std::ceil(nsweeps/double(nchains_));
+
+    std::cout<<"# Starting Monte Carlo sampling"<<std::endl;
+    std::cout<<"# Number of sweeps to be performed is "<<nsweeps<<std::endl;
+    std::cout<<"# Using "<<nchains_<<" independent Markov chains on ";
+    std::cout<<nthreads_<<" threads, "<<nsweepschain<<" sweeps per chain"<<std::endl;
+
+    std::cout<<"# Thermalization and sweeping... ";
+    std::flush(std::cout);
+
+    std::vector<std::thread> threads;
+
+    for(int t=0;t<nthreads_;t++){
+      threads.push_back(std::thread([this,t,nsweeps,nsweepschain,thermfactor,sweepfactor,nflips](){
+        for(int c=t;c<nchains_;c+=nthreads_){
+          const double done=samplers_[c]->Prepare(nsweeps*thermfactor,sweepfactor,nflips);
+          samplers_[c]->Sweep(nsweepschain-done,sweepfactor,nflips);
+        }
+      }));
+    }
+
+    for(auto & thread : threads){
+      thread.join();
+    }
+
+    std::cout<<" DONE "<<std::endl;
+    std::flush(std::cout);
+
+    //merging the measurements of all the chains into the first one
+    for(int c=1;c<nchains_;c++){
+      samplers_[0]->Merge(*samplers_[c]);
+    }
+
+    samplers_[0]->OutputEnergy();
+
+    samplers_[0]->OutputProfile();
+  }
+
+};
@@ -0,0 +1,240 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+#if defined(NQS_PROFILE) && defined(__GNUC__) && defined(__x86_64__)
+#include <x86intrin.h>
+#define NQS_PROFILE_TSC
+#endif
+
+//Instrumentation of the Monte Carlo sampling
+//
+//When compiled with -DNQS_PROFILE the samplers record, separately for the
+//thermalization and for the sampling sweeps, the time spent in their main
+//phases, measured with the time-stamp counter of the CPU, and counters of
+//proposed and accepted moves, measurements, connected states and bytes of
+//sampled configurations written. A JSON or CSV summary is written at the
+//end of the run (see Write).
+//The time-stamp counter is converted to seconds by comparing it with the
+//steady clock over the lifetime of the profile.
+//Without NQS_PROFILE all the methods are empty and inlined away, so that
+//release builds carry no overhead.
+//Timers are inclusive: PoP and UpdateLt are part of Moves, FindConn and
+//ConnPoP are the two parts of the energy measurement.
+class Profile{
+
+public:
+
+  enum Stage{Thermalization,Sampling,NStages};
+
+  enum Timer{Moves,PoP,UpdateLt,FindConn,ConnPoP,WriteState,Checkpoint,NTimers};
+
+  enum Counter{Proposals,Accepts,Measurements,ConnStates,BytesWritten,NCounters};
+
+#if defined(NQS_PROFILE)
+  static const bool Enabled=true;
+#else
+  static const bool Enabled=false;
+#endif
+
+private:
+
+  Stage stage_;
+
+  std::uint64_t ticks_[NStages][NTimers];
+  std::uint64_t calls_[NStages][NTimers];
+  std::uint64_t counts_[NStages][NCounters];
+
+  //reference points for the conversion of ticks to seconds
+  std::uint64_t tick0_;
+  std::chrono::steady_clock::time_point time0_;
+
+public:
+
+  Profile():stage_(Thermalization){
+    Reset();
+  }
+
+  void Reset(){
+    for(int s=0;s<NStages;s++){
+      for(int t=0;t<NTimers;t++){
+        ticks_[s][t]=0;
+        calls_[s][t]=0;
+      }
+      for(int c=0;c<NCounters;c++){
+        counts_[s][c]=0;
+      }
+    }
+    tick0_=Ticks();
+    time0_=std::chrono::steady_clock::now();
+  }
+
+  //current value of the time-stamp counter (nanoseconds of the steady
+  //clock where it is not available)
+  static inline std::uint64_t Ticks(){
+#if defined(NQS_PROFILE_TSC)
+    return __rdtsc();
+#elif defined(NQS_PROFILE)
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+    return 0;
+#endif
+  }
+
+  inline void SetStage(Stage stage){
+    stage_=stage;
+  }
+
+  //a timed section goes from start=Start() to Stop(timer,start)
+  inline std::uint64_t Start()const{
+    return Ticks();
+  }
+
+  inline void Stop(Timer timer,std::uint64_t start){
+#if defined(NQS_PROFILE)
+    ticks_[stage_][timer]+=Ticks()-start;
+    calls_[stage_][timer]+=1;
+#else
+    (void)timer;
+    (void)start;
+#endif
+  }
+
+  inline void Count(Counter counter,std::uint64_t n=1){
+#if defined(NQS_PROFILE)
+    counts_[stage_][counter]+=n;
+#else
+    (void)counter;
+    (void)n;
+#endif
+  }
+
+  //adds the timers and counters of another profile (e.g. another chain)
+  void Merge(const Profile & other){
+    for(int s=0;s<NStages;s++){
+      for(int t=0;t<NTimers;t++){
+        ticks_[s][t]+=other.ticks_[s][t];
+        calls_[s][t]+=other.calls_[s][t];
+      }
+      for(int c=0;c<NCounters;c++){
+        counts_[s][c]+=other.counts_[s][c];
+      }
+    }
+  }
+
+  //ticks of the time-stamp counter per second
+  double TicksPerSecond()const{
+    const double seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-time0_).count();
+    return (seconds>0)?double(Ticks()-tick0_)/seconds:0;
+  }
+
+  static const char * StageName(int s){
+    static const char * names[NStages]={"thermalization","sampling"};
+    return names[s];
+  }
+
+  static const char * TimerName(int t){
+    static const char * names[NTimers]={"moves","pop","updatelt","findconn","connpop","writestate","checkpoint"};
+    return names[t];
+  }
+
+  static const char * CounterName(int c){
+    static const char * names[NCounters]={"proposals","accepts","measurements","connstates","byteswritten"};
+    return names[c];
+  }
+
+  //writes the summary in JSON format, or in CSV format (one row per timer
+  //or counter) if csv=true
+  void Write(std::ostream & out,bool csv=false)const{
+    const double tps=TicksPerSecond();
+    const double spt=(tps>0)?1./tps:0;
+
+    out<<std::setprecision(9);
+
+    if(csv){
+      out<<"stage,kind,name,count,ticks,seconds"<<std::endl;
+      for(int s=0;s<NStages;s++){
+        for(int t=0;t<NTimers;t++){
+          out<<StageName(s)<<",timer,"<<TimerName(t)<<","<<calls_[s][t]<<",";
+          out<<ticks_[s][t]<<","<<double(ticks_[s][t])*spt<<std::endl;
+        }
+        for(int c=0;c<NCounters;c++){
+          out<<StageName(s)<<",counter,"<<CounterName(c)<<","<<counts_[s][c]<<",,"<<std::endl;
+        }
+      }
+      return;
+    }
+
+    out<<"{"<<std::endl;
+    out<<"  \"ticks_per_second\": "<<tps<<","<<std::endl;
+    out<<"  \"stages\": {"<<std::endl;
+    for(int s=0;s<NStages;s++){
+      out<<"    \""<<StageName(s)<<"\": {"<<std::endl;
+      out<<"      \"timers\": {"<<std::endl;
+      for(int t=0;t<NTimers;t++){
+        out<<"        \""<<TimerName(t)<<"\": {\"calls\": "<<calls_[s][t]<<", \"ticks\": "<<ticks_[s][t];
+        out<<", \"seconds\": "<<double(ticks_[s][t])*spt<<"}"<<((t+1<NTimers)?",":"")<<std::endl;
+      }
+      out<<"      },"<<std::endl;
+      out<<"      \"counters\": {"<<std::endl;
+      for(int c=0;c<NCounters;c++){
+        out<<"        \""<<CounterName(c)<<"\": "<<counts_[s][c]<<((c+1<NCounters)?",":"")<<std::endl;
+      }
+      out<<"      },"<<std::endl;
+      const double proposals=counts_[s][Proposals];
+      out<<"      \"acceptance\": "<<((proposals>0)?double(counts_[s][Accepts])/proposals:0)<<std::endl;
+      out<<"    }"<<((s+1<NStages)?",":"")<<std::endl;
+    }
+    out<<"  }"<<std::endl;
+    out<<"}"<<std::endl;
+  }
+
+  //writes the summary on the given file, in CSV format if its name ends
+  //with .csv and in JSON format otherwise, or on standard output if
+  //filename is empty
+  void Write(std::string filename)const{
+    if(filename.empty()){
+      std::cout<<"# Profile of the sampling (JSON)"<<std::endl;
+      Write(std::cout,false);
+      return;
+    }
+
+    std::ofstream fout(filename.c_str());
+    if(!fout.is_open()){
+      std::cerr<<"# Error : Cannot open file "<<filename<<" for writing"<<std::endl;
+      std::abort();
+    }
+    const bool csv=(filename.size()>=4 && filename.compare(filename.size()-4,4,".csv")==0);
+    Write(fout,csv);
+    std::cout<<"# Profile of the sampling written to file "<<filename<<std::endl;
+  }
+
+};
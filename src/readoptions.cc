@@ -27,6 +27,9 @@ All use of these programs is entirely at the user's own risk.
 #include <map>
 #include <iostream>
 #include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
 
 //Various utilities to read the command line options
 
@@ -68,6 +71,24 @@ std::string FindCoupling(std::string strarg){
   return "error";
 }
 
+//splits a list of comma-separated values
+std::vector<std::string> SplitList(std::string list,char sep=','){
+  std::vector<std::string> items;
+  std::size_t start=0;
+  while(true){
+    std::size_t found=list.find(sep,start);
+    std::string item=list.substr(start,(found==std::string::npos)?std::string::npos:(found-start));
+    if(item.size()>0){
+      items.push_back(item);
+    }
+    if(found==std::string::npos){
+      break;
+    }
+    start=found+1;
+  }
+  return items;
+}
+
 void PrintHeader(){
   std::cout<<std::endl;
   std::cout<<"\t|   Neural-network quantum states sampler   |"<<std::endl;
@@ -92,9 +113,98 @@ void PrintInfoMessage(){
   std::cout<<"\tseed<0 sets it to the internal clock value"<<std::endl;
   std::cout<<"\t(default value is -1)"<<std::endl<<std::endl;
 
+  std::cout<<"--rng=... "<<std::endl;
+  std::cout<<"\tpseudo-random number generator, mt19937 or xoshiro"<<std::endl;
+  std::cout<<"\t(default value is mt19937)"<<std::endl<<std::endl;
+
+  std::cout<<"--exact=... "<<std::endl;
+  std::cout<<"\tcomputes the exact energy enumerating all the configurations (full)"<<std::endl;
+  std::cout<<"\tor only the ones with zero magnetization (sz0), instead of sampling"<<std::endl;
+  std::cout<<"\t(feasible for up to about 30 spins)"<<std::endl<<std::endl;
+
+  std::cout<<"--proposals=... "<<std::endl;
+  std::cout<<"\tgeneration of the Monte Carlo moves, batched or sequential"<<std::endl;
+  std::cout<<"\t(sequential reproduces the Markov chains of previous versions)"<<std::endl;
+  std::cout<<"\t(default value is batched)"<<std::endl<<std::endl;
+
+  std::cout<<"--replicas=... "<<std::endl;
+  std::cout<<"\tcomma-separated list of wave-function files of the same system,"<<std::endl;
+  std::cout<<"\tsampled together with one Markov chain per file"<<std::endl;
+  std::cout<<"\t(replaces --filename)"<<std::endl<<std::endl;
+
+  std::cout<<"--swapinterval=... "<<std::endl;
+  std::cout<<"\tnumber of sweeps between swaps of neighbouring replicas, 0 for no swaps"<<std::endl;
+  std::cout<<"\t(default value is 10)"<<std::endl<<std::endl;
+
+  std::cout<<"--batch=... "<<std::endl;
+  std::cout<<"\tsamples many wave-function files in a single run, given as a glob pattern"<<std::endl;
+  std::cout<<"\t(e.g. 'Ground/*.wf', quoted) or as @LISTFILE, LISTFILE containing a file per row"<<std::endl;
+  std::cout<<"\t(replaces --filename)"<<std::endl<<std::endl;
+
+  std::cout<<"--nseeds=... "<<std::endl;
+  std::cout<<"\tnumber of independent runs per file in batch mode, with seeds SEED, SEED+1, ..."<<std::endl;
+  std::cout<<"\t(default value is 1)"<<std::endl<<std::endl;
+
+  std::cout<<"--results=... "<<std::endl;
+  std::cout<<"\tfile on which the table of results of the batch mode is written"<<std::endl;
+  std::cout<<"\t(default is the standard output)"<<std::endl<<std::endl;
+
+  std::cout<<"--checkpoint=... "<<std::endl;
+  std::cout<<"\tfile where the state of the sampling is saved, and from which it is resumed"<<std::endl;
+  std::cout<<"\tif it exists (FILE.CHAIN for more than one chain)"<<std::endl<<std::endl;
+
+  std::cout<<"--checkpointinterval=... "<<std::endl;
+  std::cout<<"\tnumber of sweeps between checkpoints"<<std::endl;
+  std::cout<<"\t(default value is 1000)"<<std::endl<<std::endl;
+
+  std::cout<<"--warmstart=... "<<std::endl;
+  std::cout<<"\tcheckpoint file whose configuration is used as initial state,"<<std::endl;
+  std::cout<<"\tskipping the thermalization"<<std::endl<<std::endl;
+
+  std::cout<<"--precision=... "<<std::endl;
+  std::cout<<"\tprecision of the wave-function evaluation, double or mixed"<<std::endl;
+  std::cout<<"\t(mixed: single-precision look-up tables, double-precision sums)"<<std::endl;
+  std::cout<<"\t(default value is double)"<<std::endl<<std::endl;
+
+  std::cout<<"--profile=... "<<std::endl;
+  std::cout<<"\tfile where the timers and counters of the sampling are written,"<<std::endl;
+  std::cout<<"\tin CSV format if its name ends with .csv and in JSON format otherwise"<<std::endl;
+  std::cout<<"\t(only for nqs_run compiled with -DNQS_PROFILE,"<<std::endl;
+  std::cout<<"\t by default the profile is printed on standard output)"<<std::endl<<std::endl;
+
+  std::cout<<"--localmoves=... "<<std::endl;
+  std::cout<<"\tfraction of the spin exchanges proposed between nearest neighbours"<<std::endl;
+  std::cout<<"\t(Heisenberg models, batched proposals only)"<<std::endl;
+  std::cout<<"\t(default value is 0)"<<std::endl<<std::endl;
+
   std::cout<<"--filestates=... "<<std::endl;
   std::cout<<"\tname of the file to print sampled configurations"<<std::endl;
   std::cout<<"\t(by default it is not set)"<<std::endl<<std::endl;
+
+  std::cout<<"--targeterror=... "<<std::endl;
+  std::cout<<"\ttarget statistical error on the energy per spin"<<std::endl;
+  std::cout<<"\tthe sampling stops as soon as the binning analysis has converged"<<std::endl;
+  std::cout<<"\tto an error smaller than the target, or after NSWEEPS sweeps"<<std::endl;
+  std::cout<<"\t(by default it is not set)"<<std::endl<<std::endl;
+
+  std::cout<<"--statesformat=... "<<std::endl;
+  std::cout<<"\tformat of the file of sampled configurations"<<std::endl;
+  std::cout<<"\ttext or binary (bit-packed, see nqs_states)"<<std::endl;
+  std::cout<<"\t(default value is text)"<<std::endl<<std::endl;
+
+  std::cout<<"--fileenergies=... "<<std::endl;
+  std::cout<<"\tname of the file to print the measured local energies"<<std::endl;
+  std::cout<<"\t(by default it is not set)"<<std::endl<<std::endl;
+
+  std::cout<<"--nchains=... "<<std::endl;
+  std::cout<<"\tnumber of independent Markov chains"<<std::endl;
+  std::cout<<"\tthe total number of sweeps is split among the chains"<<std::endl;
+  std::cout<<"\t(default value is 1)"<<std::endl<<std::endl;
+
+  std::cout<<"--threads=... "<<std::endl;
+  std::cout<<"\tnumber of threads used to run the Markov chains"<<std::endl;
+  std::cout<<"\t(default value is the number of chains,"<<std::endl;
+  std::cout<<"\t capped to the number of available cores)"<<std::endl<<std::endl;
 }
 
 std::map<std::string,std::string> ReadOptions(int argc,char *argv[]){
@@ -118,13 +228,32 @@ std::map<std::string,std::string> ReadOptions(int argc,char *argv[]){
         {"nsweeps",  required_argument, 0, 'b'},
         {"seed",    required_argument, 0, 'c'},
         {"filestates",    required_argument, 0, 'd'},
+        {"nchains",    required_argument, 0, 'e'},
+        {"threads",    required_argument, 0, 'f'},
+        {"statesformat",    required_argument, 0, 'g'},
+        {"targeterror",    required_argument, 0, 'h'},
+        {"fileenergies",    required_argument, 0, 'i'},
+        {"rng",    required_argument, 0, 'j'},
+        {"proposals",    required_argument, 0, 'k'},
+        {"exact",    required_argument, 0, 'l'},
+        {"localmoves",    required_argument, 0, 'm'},
+        {"replicas",    required_argument, 0, 'n'},
+        {"swapinterval",    required_argument, 0, 'o'},
+        {"batch",    required_argument, 0, 'p'},
+        {"nseeds",    required_argument, 0, 'q'},
+        {"results",    required_argument, 0, 'r'},
+        {"checkpoint",    required_argument, 0, 's'},
+        {"checkpointinterval",    required_argument, 0, 't'},
+        {"warmstart",    required_argument, 0, 'u'},
+        {"precision",    required_argument, 0, 'v'},
+        {"profile",    required_argument, 0, 'w'},
         {0, 0, 0, 0}
       };
 
     /* getopt_long stores the option index here. */
     int option_index = 0;
 
-    int c = getopt_long (argc, argv, "a:b:c:d:",
+    int c = getopt_long (argc, argv, "a:b:c:d:e:f:g:h:i:j:k:l:m:n:o:p:q:r:s:t:u:v:w:",
                      long_options, &option_index);
 
     /* Detect the end of the options. */
@@ -149,6 +278,82 @@ std::map<std::string,std::string> ReadOptions(int argc,char *argv[]){
         options["filestates"]=optarg;
         break;
 
+      case 'e':
+        options["nchains"]=optarg;
+        break;
+
+      case 'f':
+        options["threads"]=optarg;
+        break;
+
+      case 'g':
+        options["statesformat"]=optarg;
+        break;
+
+      case 'h':
+        options["targeterror"]=optarg;
+        break;
+
+      case 'i':
+        options["fileenergies"]=optarg;
+        break;
+
+      case 'j':
+        options["rng"]=optarg;
+        break;
+
+      case 'k':
+        options["proposals"]=optarg;
+        break;
+
+      case 'l':
+        options["exact"]=optarg;
+        break;
+
+      case 'm':
+        options["localmoves"]=optarg;
+        break;
+
+      case 'n':
+        options["replicas"]=optarg;
+        break;
+
+      case 'o':
+        options["swapinterval"]=optarg;
+        break;
+
+      case 'p':
+        options["batch"]=optarg;
+        break;
+
+      case 'q':
+        options["nseeds"]=optarg;
+        break;
+
+      case 'r':
+        options["results"]=optarg;
+        break;
+
+      case 's':
+        options["checkpoint"]=optarg;
+        break;
+
+      case 't':
+        options["checkpointinterval"]=optarg;
+        break;
+
+      case 'u':
+        options["warmstart"]=optarg;
+        break;
+
+      case 'v':
+        options["precision"]=optarg;
+        break;
+
+      case 'w':
+        options["profile"]=optarg;
+        break;
+
       case '?':
         PrintInfoMessage();
         break;
@@ -158,7 +363,98 @@ std::map<std::string,std::string> ReadOptions(int argc,char *argv[]){
       }
   }
 
-  if(options.count("filename")==0){
+  //replicas must describe the same hamiltonian, the first one
+  //being used as the main wave-function
+  if(options.count("replicas")){
+    std::vector<std::string> replicas=SplitList(options["replicas"]);
+    if(replicas.size()==0 || options.count("filename")){
+      std::cerr<<"# Error: Option replicas must be a non-empty list of files, and replaces filename"<<std::endl;
+      std::abort();
+    }
+    for(const auto & replica : replicas){
+      if(FindModel(replica)!=FindModel(replicas[0]) || FindCoupling(replica)!=FindCoupling(replicas[0])){
+        std::cerr<<"# Error: All the replicas should refer to the same model and coupling"<<std::endl;
+        std::abort();
+      }
+    }
+    options["filename"]=replicas[0];
+  }
+
+  if(options.count("swapinterval")==0){
+    options["swapinterval"]="10";
+  }
+
+  if(options.count("batch") && options.count("filename")){
+    std::cerr<<"# Error: Options batch and filename cannot be used together"<<std::endl;
+    std::abort();
+  }
+
+  //the batch mode writes only the table of results, in double precision
+  if(options.count("batch") && (options.count("filestates") || options.count("fileenergies"))){
+    std::cerr<<"# Error: Options filestates and fileenergies cannot be used with batch"<<std::endl;
+    std::abort();
+  }
+
+  if(options.count("batch") && options.count("precision") && options["precision"]!="double"){
+    std::cerr<<"# Error: Option batch supports only double precision"<<std::endl;
+    std::abort();
+  }
+
+  //the batch mode samples every file, one file per thread
+  if(options.count("batch") && (options.count("exact") || options.count("nchains"))){
+    std::cerr<<"# Error: Options exact and nchains cannot be used with batch"<<std::endl;
+    std::abort();
+  }
+
+  //the exact enumeration is done on a single wave-function
+  if(options.count("replicas") && options.count("exact")){
+    std::cerr<<"# Error: Options replicas and exact cannot be used together"<<std::endl;
+    std::abort();
+  }
+
+  if((options.count("checkpoint") || options.count("warmstart")) &&
+    (options.count("batch") || options.count("replicas") || options.count("exact"))){
+    std::cerr<<"# Error: Options checkpoint and warmstart cannot be used with batch, replicas or exact"<<std::endl;
+    std::abort();
+  }
+
+#if !defined(NQS_PROFILE)
+  if(options.count("profile")){
+    std::cerr<<"# Error: Option profile needs nqs_run compiled with -DNQS_PROFILE"<<std::endl;
+    std::abort();
+  }
+#endif
+
+  if(options.count("profile") &&
+    (options.count("batch") || options.count("replicas") || options.count("exact"))){
+    std::cerr<<"# Error: Option profile cannot be used with batch, replicas or exact"<<std::endl;
+    std::abort();
+  }
+
+  //replicas run one chain each and always for NSWEEPS sweeps
+  if(options.count("replicas") && (options.count("nchains") || options.count("targeterror"))){
+    std::cerr<<"# Error: Options nchains and targeterror cannot be used with replicas"<<std::endl;
+    std::abort();
+  }
+
+  if(options.count("precision")==0){
+    options["precision"]="double";
+  }
+
+  if(options["precision"]!="double" && options["precision"]!="mixed"){
+    std::cerr<<"# Error: Option precision must be either double or mixed"<<std::endl;
+    std::abort();
+  }
+
+  if(options.count("checkpointinterval")==0){
+    options["checkpointinterval"]="1000";
+  }
+
+  if(options.count("nseeds")==0){
+    options["nseeds"]="1";
+  }
+
+  if(options.count("filename")==0 && options.count("batch")==0){
     std::cerr<<"# Error: Option filename must be specified with the option --filename=FILENAME"<<std::endl;
     std::abort();
   }
@@ -171,6 +467,73 @@ std::map<std::string,std::string> ReadOptions(int argc,char *argv[]){
     options["seed"]="-1";
   }
 
+  if(options.count("rng")==0){
+    options["rng"]="mt19937";
+  }
+
+  if(options["rng"]!="mt19937" && options["rng"]!="xoshiro"){
+    std::cerr<<"# Error: Option rng must be either mt19937 or xoshiro"<<std::endl;
+    std::abort();
+  }
+
+  if(options.count("proposals")==0){
+    options["proposals"]="batched";
+  }
+
+  if(options["proposals"]!="batched" && options["proposals"]!="sequential"){
+    std::cerr<<"# Error: Option proposals must be either batched or sequential"<<std::endl;
+    std::abort();
+  }
+
+  if(options.count("localmoves")==0){
+    options["localmoves"]="0";
+  }
+
+  if(options.count("exact") && options["exact"]!="full" && options["exact"]!="sz0"){
+    std::cerr<<"# Error: Option exact must be either full or sz0"<<std::endl;
+    std::abort();
+  }
+
+  if(options.count("targeterror")==0){
+    options["targeterror"]="0";
+  }
+
+  if(options.count("statesformat")==0){
+    options["statesformat"]="text";
+  }
+
+  if(options["statesformat"]!="text" && options["statesformat"]!="binary"){
+    std::cerr<<"# Error: Option statesformat must be either text or binary"<<std::endl;
+    std::abort();
+  }
+
+  if(options.count("nchains")==0){
+    options["nchains"]="1";
+  }
+
+  if(options.count("threads")==0){
+    int ncores=std::thread::hardware_concurrency();
+    int nchains=std::stoi(options["nchains"]);
+    //the exact enumeration uses all the available cores
+    if(options.count("exact")){
+      nchains=std::max(ncores,1);
+    }
+    //one thread per replica
+    if(options.count("replicas")){
+      nchains=SplitList(options["replicas"]).size();
+    }
+    //the batch mode uses all the available cores
+    if(options.count("batch")){
+      nchains=std::max(ncores,1);
+    }
+    options["threads"]=std::to_string((ncores>0)?std::min(nchains,ncores):nchains);
+  }
+
+  //in batch mode the model is found for each file
+  if(options.count("batch")){
+    return options;
+  }
+
   options["model"]=FindModel(options["filename"]);
 
   if(options["model"]=="Ising1d"){
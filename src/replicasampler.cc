@@ -0,0 +1,254 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <ctime>
+
+//Monte Carlo sampling of several wave-functions of the same system at once
+//(e.g. a sequence of time-evolved snapshots), one Markov chain per
+//wave-function (replica)
+//The chains are warm started: only the first replica is thermalized from a
+//random state, the others start from its thermalized configuration
+//Every swapinterval sweeps, exchanges of the configurations of neighbouring
+//replicas are proposed and accepted with the Metropolis rule
+//|Psi_r(y) Psi_r+1(x)|^2/|Psi_r(x) Psi_r+1(y)|^2
+//which leaves the joint distribution of all the replicas unchanged
+template<class Wf,class Hamiltonian,class Rng=StdRng> class ReplicaSampler{
+
+  typedef Sampler<Wf,Hamiltonian,Rng> ChainSampler;
+
+  //number of replicas
+  const int nreplicas_;
+
+  //number of threads used to run the replicas
+  const int nthreads_;
+
+  //wave-functions, one per replica
+  std::vector<Wf> wfs_;
+
+  //names of the wave-functions, used in the output
+  std::vector<std::string> names_;
+
+  //samplers, one per replica
+  std::vector<std::unique_ptr<ChainSampler> > samplers_;
+
+  //random numbers for the swaps
+  Rng rng_;
+
+  //number of sweeps between swap attempts, 0 disables the swaps
+  int swapinterval_;
+
+  //fraction of the thermalization sweeps done by the warm-started replicas
+  double warmfactor_;
+
+  //swap statistics for each pair of neighbouring replicas
+  std::vector<double> swapaccept_;
+  std::vector<double> swapmoves_;
+
+public:
+
+  ReplicaSampler(const std::vector<Wf> & wfs,const std::vector<std::string> & names,
+    Hamiltonian & hamiltonian,int seed,int nthreads):
+    nreplicas_(wfs.size()),nthreads_(std::min(nthreads,int(wfs.size()))),wfs_(wfs),names_(names),
+    swapinterval_(10),warmfactor_(0.1),swapaccept_(wfs.size(),0.),swapmoves_(wfs.size(),0.){
+
+    if(nreplicas_<1 || nthreads_<1){
+      std::cerr<<"# Error : The number of replicas and threads should be positive integers"<<std::endl;
+      std::abort();
+    }
+
+    for(int r=1;r<nreplicas_;r++){
+      if(wfs_[r].Nspins()!=wfs_[0].Nspins()){
+        std::cerr<<"# Error : All the replicas should have the same number of spins"<<std::endl;
+        std::abort();
+      }
+    }
+
+    //every replica uses a different stream of the random number policy,
+    //the last stream is used for the swaps
+    const int baseseed=(seed<0)?int(std::time(nullptr)):seed;
+
+    for(int r=0;r<nreplicas_;r++){
+      samplers_.push_back(std::unique_ptr<ChainSampler>(new ChainSampler(wfs_[r],hamiltonian,baseseed,r)));
+      samplers_[r]->SetVerbose(false);
+    }
+    rng_.Seed(baseseed,nreplicas_);
+  }
+
+  //sets the number of sweeps between swap attempts (0 disables the swaps)
+  void SetSwapInterval(int swapinterval){
+    if(swapinterval<0){
+      std::cerr<<"# Error : The swap interval should be a non-negative integer"<<std::endl;
+      std::abort();
+    }
+    swapinterval_=swapinterval;
+  }
+
+  void SetBatchedProposals(bool batched){
+    for(int r=0;r<nreplicas_;r++){
+      samplers_[r]->SetBatchedProposals(batched);
+    }
+  }
+
+  void SetLocalMoves(double localratio){
+    for(int r=0;r<nreplicas_;r++){
+      samplers_[r]->SetLocalMoves(localratio);
+    }
+  }
+
+  //each replica writes its measured energies on a separate file FILENAME.REPLICA
+  void SetFileEnergies(std::string filename){
+    for(int r=0;r<nreplicas_;r++){
+      samplers_[r]->SetFileEnergies(filename+"."+std::to_string(r));
+    }
+    std::cout<<"# Saving measured energies to files "<<filename<<".REPLICA"<<std::endl;
+  }
+
+  //each replica writes its sampled configurations on a separate file FILENAME.REPLICA
+  void SetFileStates(std::string filename,bool binary=false){
+    for(int r=0;r<nreplicas_;r++){
+      samplers_[r]->SetFileStates(filename+"."+std::to_string(r),binary);
+    }
+    std::cout<<"# Saving sampled configurations to files "<<filename<<".REPLICA";
+    std::cout<<(binary?" (binary format)":"")<<std::endl;
+  }
+
+  //Run the Monte Carlo sampling
+  //every replica performs nsweeps sweeps
+  //the first replica is thermalized for nsweeps*thermfactor sweeps, the others
+  //for a fraction warmfactor_ of them
+  //the other parameters have the same meaning as in Sampler::Run
+  void Run(double nsweeps,double thermfactor=0.1,int sweepfactor=1,int nflipss=-1){
+
+    const int nflips=samplers_[0]->CheckInput(nsweeps,thermfactor,nflipss);
+
+    std::cout<<"# Starting Monte Carlo sampling of "<<nreplicas_<<" replicas on ";
+    std::cout<<nthreads_<<" threads"<<std::endl;
+    std::cout<<"# Number of sweeps to be performed is "<<nsweeps<<" per replica"<<std::endl;
+    if(swapinterval_>0){
+      std::cout<<"# Swaps between neighbouring replicas every "<<swapinterval_<<" sweeps"<<std::endl;
+    }
+
+    std::cout<<"# Thermalization... ";
+    std::flush(std::cout);
+
+    const double ntherm=nsweeps*thermfactor;
+
+    samplers_[0]->Thermalize(ntherm,sweepfactor,nflips);
+
+    for(int r=1;r<nreplicas_;r++){
+      samplers_[r]->SetState(samplers_[0]->State());
+    }
+
+    ForEachReplica(1,[this,ntherm,sweepfactor,nflips](int r){
+      samplers_[r]->Thermalize(ntherm*warmfactor_,sweepfactor,nflips,false);
+    });
+
+    std::cout<<" DONE "<<std::endl;
+    std::cout<<"# Sweeping... ";
+    std::flush(std::cout);
+
+    const double nround=(swapinterval_>0)?double(swapinterval_):nsweeps;
+
+    int parity=0;
+    for(double n=0;n<nsweeps;n+=nround){
+      const double nsweepsround=std::min(nround,nsweeps-n);
+
+      ForEachReplica(0,[this,nsweepsround,sweepfactor,nflips](int r){
+        samplers_[r]->Sweep(nsweepsround,sweepfactor,nflips);
+      });
+
+      if(swapinterval_>0){
+        Swaps(parity);
+        parity=1-parity;
+      }
+    }
+
+    std::cout<<" DONE "<<std::endl;
+    std::flush(std::cout);
+
+    OutputEnergy();
+  }
+
+  void OutputEnergy(){
+    for(int r=0;r<nreplicas_;r++){
+      std::cout<<"# Replica "<<r<<" : "<<names_[r]<<std::endl;
+      samplers_[r]->OutputEnergy();
+    }
+
+    if(swapinterval_>0 && nreplicas_>1){
+      std::cout<<"# Acceptance of the swaps between neighbouring replicas : "<<std::endl;
+      for(int r=0;r+1<nreplicas_;r++){
+        std::cout<<"# "<<r<<" <-> "<<r+1<<" : "<<std::fixed<<std::setprecision(3);
+        std::cout<<((swapmoves_[r]>0)?swapaccept_[r]/swapmoves_[r]:0.)<<std::endl;
+      }
+    }
+  }
+
+private:
+
+  //runs f(r) for the replicas r>=r0, distributed over the threads
+  template<class Function> void ForEachReplica(int r0,Function f){
+    std::vector<std::thread> threads;
+
+    for(int t=0;t<nthreads_;t++){
+      threads.push_back(std::thread([this,t,r0,&f](){
+        for(int r=r0+t;r<nreplicas_;r+=nthreads_){
+          f(r);
+        }
+      }));
+    }
+
+    for(auto & thread : threads){
+      thread.join();
+    }
+  }
+
+  //proposes the swaps of the pairs (r,r+1) with r of the given parity
+  void Swaps(int parity){
+    for(int r=parity;r+1<nreplicas_;r+=2){
+      const std::vector<int> x=samplers_[r]->State();
+      const std::vector<int> y=samplers_[r+1]->State();
+
+      const std::complex<double> logratio=wfs_[r].LogVal(y)+wfs_[r+1].LogVal(x)
+        -samplers_[r]->LogVal()-samplers_[r+1]->LogVal();
+
+      swapmoves_[r]+=1;
+
+      if(std::exp(2.*logratio.real())>rng_.Uniform()){
+        samplers_[r]->SetState(y);
+        samplers_[r+1]->SetState(x);
+        swapaccept_[r]+=1;
+      }
+    }
+  }
+
+};
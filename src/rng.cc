@@ -0,0 +1,281 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include <random>
+#include <cstdint>
+#include <string>
+#include <sstream>
+
+//Random number policies for the Monte Carlo samplers
+//
+//A policy provides
+//  Seed(seed,stream) : initializes the generator, independent streams
+//                      (e.g. for parallel chains) are labelled by stream
+//  Uniform()         : a random number uniform in [0,1)
+//  Uniform(out,n)    : n random numbers uniform in [0,1)
+//  Index(n)          : a random integer uniform in [0,n-1]
+//  Name()            : the name of the generator
+//  Save(out),Load(in): binary image of the state for checkpoints
+
+//Mersenne twister with the distributions of the standard library
+//This is the generator used since the first version of the code,
+//and it reproduces exactly its sequences of random numbers.
+//Streams are obtained seeding with seed+stream.
+class StdRng{
+
+  std::mt19937 gen_;
+  std::uniform_real_distribution<> distu_;
+
+public:
+
+  StdRng():distu_(0,1){}
+
+  inline void Seed(std::uint64_t seed,int stream=0){
+    gen_.seed(seed+stream);
+  }
+
+  inline double Uniform(){
+    return distu_(gen_);
+  }
+
+  inline void Uniform(double * out,int n){
+    for(int i=0;i<n;i++){
+      out[i]=distu_(gen_);
+    }
+  }
+
+  inline int Index(int n){
+    return std::uniform_int_distribution<>(0,n-1)(gen_);
+  }
+
+  static std::string Name(){
+    return "mt19937";
+  }
+
+  void Save(CheckpointWriter & out)const{
+    std::ostringstream os;
+    os<<gen_;
+    out.Put(os.str());
+  }
+
+  void Load(CheckpointReader & in){
+    std::string state;
+    in.Get(state);
+    std::istringstream is(state);
+    is>>gen_;
+    if(is.fail()){
+      in.Fail("invalid state of the random number generator");
+    }
+  }
+
+};
+
+//xoshiro256+ generator (D. Blackman and S. Vigna, 2018)
+//Four independent xoshiro256+ generators (lanes) are advanced together,
+//so that the generation of blocks of random numbers is vectorized.
+//The lanes are 2^128 steps apart on the xoshiro256 sequence, and
+//different streams are 2^192 steps apart, so that they never overlap.
+//Random numbers are produced in blocks of blocksize_ and consumed from
+//an internal buffer.
+class XoshiroRng{
+
+  static const int nlanes_=4;
+  static const int blocksize_=64;
+
+  //state of the lanes, s_[k][lane]
+  std::uint64_t s_[4][nlanes_];
+
+  //buffer of raw 64-bit random numbers and position of the next one
+  std::uint64_t buffer_[blocksize_];
+  int next_;
+
+public:
+
+  XoshiroRng(){
+    Seed(0);
+  }
+
+  void Seed(std::uint64_t seed,int stream=0){
+    //the initial state is obtained from the seed with splitmix64
+    std::uint64_t state[4];
+    std::uint64_t x=seed;
+    for(int k=0;k<4;k++){
+      x+=0x9e3779b97f4a7c15ULL;
+      std::uint64_t z=x;
+      z=(z^(z>>30))*0xbf58476d1ce4e5b9ULL;
+      z=(z^(z>>27))*0x94d049bb133111ebULL;
+      state[k]=z^(z>>31);
+    }
+
+    for(int s=0;s<stream;s++){
+      Jump(state,LongJumpPoly());
+    }
+
+    for(int lane=0;lane<nlanes_;lane++){
+      for(int k=0;k<4;k++){
+        s_[k][lane]=state[k];
+      }
+      Jump(state,JumpPoly());
+    }
+
+    next_=blocksize_;
+  }
+
+  inline double Uniform(){
+    return ToDouble(Next());
+  }
+
+  inline void Uniform(double * out,int n){
+    for(int i=0;i<n;i++){
+      out[i]=ToDouble(Next());
+    }
+  }
+
+  //uniform integer in [0,n-1] with Lemire's multiply-and-reject method
+  inline int Index(int n){
+    const std::uint32_t range=n;
+    std::uint64_t m=std::uint64_t(std::uint32_t(Next()>>32))*range;
+    std::uint32_t low=std::uint32_t(m);
+
+    if(low<range){
+      const std::uint32_t threshold=(-range)%range;
+      while(low<threshold){
+        m=std::uint64_t(std::uint32_t(Next()>>32))*range;
+        low=std::uint32_t(m);
+      }
+    }
+    return int(m>>32);
+  }
+
+  static std::string Name(){
+    return "xoshiro256+";
+  }
+
+  void Save(CheckpointWriter & out)const{
+    for(int k=0;k<4;k++){
+      for(int lane=0;lane<nlanes_;lane++){
+        out.Put(s_[k][lane]);
+      }
+    }
+    for(int b=0;b<blocksize_;b++){
+      out.Put(buffer_[b]);
+    }
+    out.Put(std::int32_t(next_));
+  }
+
+  void Load(CheckpointReader & in){
+    for(int k=0;k<4;k++){
+      for(int lane=0;lane<nlanes_;lane++){
+        in.Get(s_[k][lane]);
+      }
+    }
+    for(int b=0;b<blocksize_;b++){
+      in.Get(buffer_[b]);
+    }
+    std::int32_t next;
+    in.Get(next);
+    if(next<0 || next>blocksize_){
+      in.Fail("invalid state of the random number generator");
+    }
+    next_=next;
+  }
+
+  inline std::uint64_t Next(){
+    if(next_==blocksize_){
+      Fill();
+    }
+    return buffer_[next_++];
+  }
+
+private:
+
+  static inline std::uint64_t Rotl(std::uint64_t x,int k){
+    return (x<<k)|(x>>(64-k));
+  }
+
+  //53 random bits to a double in [0,1)
+  static inline double ToDouble(std::uint64_t x){
+    return double(x>>11)*(1./9007199254740992.);
+  }
+
+  //refills the buffer, advancing all the lanes together
+  void Fill(){
+    for(int b=0;b<blocksize_;b+=nlanes_){
+      for(int lane=0;lane<nlanes_;lane++){
+        buffer_[b+lane]=s_[0][lane]+s_[3][lane];
+
+        const std::uint64_t t=s_[1][lane]<<17;
+
+        s_[2][lane]^=s_[0][lane];
+        s_[3][lane]^=s_[1][lane];
+        s_[1][lane]^=s_[2][lane];
+        s_[0][lane]^=s_[3][lane];
+
+        s_[2][lane]^=t;
+        s_[3][lane]=Rotl(s_[3][lane],45);
+      }
+    }
+    next_=0;
+  }
+
+  static const std::uint64_t * JumpPoly(){
+    static const std::uint64_t poly[4]={0x180ec6d33cfd0abaULL,0xd5a61266f0c9392cULL,
+                                        0xa9582618e03fc9aaULL,0x39abdc4529b1661cULL};
+    return poly;
+  }
+
+  static const std::uint64_t * LongJumpPoly(){
+    static const std::uint64_t poly[4]={0x76e15d3efefdcbbfULL,0xc5004e441c522fb3ULL,
+                                        0x77710069854ee241ULL,0x39109bb02acbe635ULL};
+    return poly;
+  }
+
+  //advances a single xoshiro256 state by the jump encoded in poly
+  static void Jump(std::uint64_t * state,const std::uint64_t * poly){
+    std::uint64_t s0=0,s1=0,s2=0,s3=0;
+    for(int i=0;i<4;i++){
+      for(int b=0;b<64;b++){
+        if(poly[i]&(std::uint64_t(1)<<b)){
+          s0^=state[0];
+          s1^=state[1];
+          s2^=state[2];
+          s3^=state[3];
+        }
+        const std::uint64_t t=state[1]<<17;
+        state[2]^=state[0];
+        state[3]^=state[1];
+        state[1]^=state[2];
+        state[0]^=state[3];
+        state[2]^=t;
+        state[3]=Rotl(state[3],45);
+      }
+    }
+    state[0]=s0;
+    state[1]=s1;
+    state[2]=s2;
+    state[3]=s3;
+  }
+
+};
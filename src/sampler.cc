@@ -33,7 +33,8 @@ All use of these programs is entirely at the user's own risk.
 
 //Simple Monte Carlo sampling of a spin
 //Wave-Function
-template<class Wf,class Hamiltonian> class Sampler{
+//Rng is the random number policy (see rng.cc)
+template<class Wf,class Hamiltonian,class Rng=StdRng> class Sampler{
 
   //wave-function
   Wf & wf_;
@@ -47,10 +48,11 @@ template<class Wf,class Hamiltonian> class Sampler{
   //current state in the sampling
   std::vector<int> state_;
 
-  //random number generators and distributions
-  std::mt19937 gen_;
-  std::uniform_real_distribution<> distu_;
-  std::uniform_int_distribution<> distn_;
+  //bit-packed copy of the current state
+  SpinConfig config_;
+
+  //random number generator
+  Rng rng_;
 
   //sampling statistics
   double accept_;
@@ -59,48 +61,116 @@ template<class Wf,class Hamiltonian> class Sampler{
   //container for indices of randomly chosen spins to be flipped
   std::vector<int> flips_;
 
+  //if true the random numbers of a whole sweep are generated at once
+  //(see GenerateProposals), otherwise they are drawn move by move,
+  //reproducing the Markov chains of previous versions of the code
+  bool batched_;
+
+  //pre-generated proposals for the current sweep
+  //the first nmoves uniforms are used for the Metropolis tests,
+  //the others are turned into the sites_ to be flipped (nflips per move)
+  std::vector<double> uniforms_;
+  std::vector<int> sites_;
+
+  //lists of the sites with spin up and down, and position of each site
+  //in its list, used to propose exchanges of two opposite spins
+  //(batched proposals with two spin flips)
+  std::vector<int> ups_;
+  std::vector<int> downs_;
+  std::vector<int> where_;
+
+  //fraction of the exchange moves proposed along a random bond
+  //of the lattice instead of between two random sites
+  double localratio_;
+
+  //pairs of nearest-neighbour sites, stored contiguously
+  std::vector<int> bonds_;
+
   //option to write the sampled configuration on a file
   bool writestates_;
-  std::ofstream filestates_;
+  StatesWriter filestates_;
+  std::string filestatesname_;
+  bool binarystates_;
 
   //quantities needed by the hamiltonian
-  //non-zero matrix elements
-  std::vector<std::complex<double> > mel_;
+  //non-zero matrix elements and flip connectors (see below for details)
+  ConnBuffer conn_;
+
+  //ratios Psi(state')/Psi(state) for the connected states
+  std::vector<std::complex<double> > pops_;
 
-  //flip connectors for the hamiltonian(see below for details)
-  std::vector<std::vector<int> > flipsh_;
+  //online binning analysis of the measured energies
+  //only O(log(nsweeps)) values are stored
+  Binning binning_;
 
-  //storage for measured values of the energy
-  std::vector<std::complex<double> > energy_;
+  //option to write the time series of the measured energies on a file
+  bool writeenergies_;
+  std::ofstream fileenergies_;
+  std::string fileenergiesname_;
+
+  //target statistical error on the energy per spin
+  //the sampling is stopped as soon as it is reached (if positive)
+  double targeterror_;
+
+  //option to print progress messages on standard output
+  bool verbose_;
+
+  //file where the state of the sampler is periodically saved,
+  //and from which an interrupted run is resumed (see checkpoint.cc)
+  std::string checkpoint_;
+  double checkpointinterval_;
+
+  //checkpoint whose configuration is used as initial state,
+  //skipping the thermalization
+  std::string warmstart_;
+
+  //true after the sampler has been restored from a checkpoint, until the
+  //sweeps start: the restored statistics are then kept
+  bool resumed_;
+
+  //timers and counters of the sampling (see profile.cc)
+  //and file where their summary is written
+  Profile profile_;
+  std::string fileprofile_;
 
 public:
 
-  Sampler(Wf & wf,Hamiltonian & hamiltonian,int seed):
-          wf_(wf),hamiltonian_(hamiltonian),distu_(0,1),nspins_(wf.Nspins()),distn_(0,nspins_-1)
+  //stream labels independent sequences of random numbers
+  //for the same seed (e.g. for parallel chains)
+  Sampler(Wf & wf,Hamiltonian & hamiltonian,int seed,int stream=0):
+          wf_(wf),hamiltonian_(hamiltonian),nspins_(wf.Nspins())
   {
 
     writestates_=false;
-    Seed(seed);
+    binarystates_=false;
+    writeenergies_=false;
+    resumed_=false;
+    verbose_=true;
+    batched_=true;
+    localratio_=0;
+    targeterror_=0;
+    checkpointinterval_=1000;
+    Seed(seed,stream);
     ResetAv();
   }
 
   ~Sampler(){
     if(writestates_){
-      filestates_.close();
+      filestates_.Close();
     }
   }
 
   //Uniform random number in [0,1)
   inline double Uniform(){
-    return distu_(gen_);
+    return rng_.Uniform();
   }
 
-  inline void Seed(int seed){
+  inline void Seed(int seed,int stream=0){
     if(seed<0){
-      gen_.seed(std::time(nullptr));
+      rng_.Seed(std::time(nullptr),stream);
     }
     else{
-      gen_.seed(seed);
+      rng_.Seed(seed,stream);
     }
   }
 
@@ -109,9 +179,9 @@ public:
   inline bool RandSpin(std::vector<int> & flips,int nflips,bool mag0=true){
     flips.resize(nflips);
 
-    flips[0]=distn_(gen_);
+    flips[0]=rng_.Index(nspins_);
     if(nflips==2){
-      flips[1]=distn_(gen_);
+      flips[1]=rng_.Index(nspins_);
       if(!mag0){
         return flips[1]!=flips[0];
       }
@@ -126,6 +196,11 @@ public:
   //Initializes a random spin state
   //if mag0=true, the initial state is prepared with zero total magnetization
   void InitRandomState(bool mag0=true){
+    if(batched_ && mag0){
+      InitRandomStateMag0();
+      return;
+    }
+
     state_.resize(nspins_);
     for(int i=0;i<nspins_;i++){
       state_[i]=(Uniform()<0.5)?(-1):(1);
@@ -143,23 +218,87 @@ public:
           magt+=state_[i];
         }
         if(magt>0){
-          int rs=distn_(gen_);
+          int rs=rng_.Index(nspins_);
           while(state_[rs]<0){
-            rs=distn_(gen_);
+            rs=rng_.Index(nspins_);
           }
           state_[rs]=-1;
           magt-=1;
         }
         else if(magt<0){
-          int rs=distn_(gen_);
+          int rs=rng_.Index(nspins_);
           while(state_[rs]>0){
-            rs=distn_(gen_);
+            rs=rng_.Index(nspins_);
           }
           state_[rs]=1;
           magt+=1;
         }
       }
     }
+
+    config_.Set(state_);
+    InitSiteLists();
+  }
+
+  //Random state with zero total magnetization, obtained choosing
+  //nspins/2 random sites to be up with a partial Fisher-Yates shuffle
+  void InitRandomStateMag0(){
+    if(nspins_%2){
+      std::cerr<<"# Error : Cannot initializate a random state with zero magnetization for odd number of spins"<<std::endl;
+      std::abort();
+    }
+
+    std::vector<int> sites(nspins_);
+    for(int i=0;i<nspins_;i++){
+      sites[i]=i;
+    }
+
+    state_.assign(nspins_,-1);
+    for(int i=0;i<nspins_/2;i++){
+      const int j=i+rng_.Index(nspins_-i);
+      std::swap(sites[i],sites[j]);
+      state_[sites[i]]=1;
+    }
+
+    config_.Set(state_);
+    InitSiteLists();
+  }
+
+  //builds the lists of up and down sites of the current state
+  void InitSiteLists(){
+    ups_.clear();
+    downs_.clear();
+    where_.resize(nspins_);
+    for(int i=0;i<nspins_;i++){
+      std::vector<int> & list=(state_[i]>0)?ups_:downs_;
+      where_[i]=list.size();
+      list.push_back(i);
+    }
+  }
+
+  //updates the lists after the exchange of the up spin at site i
+  //with the down spin at site j
+  inline void ExchangeSites(int i,int j){
+    std::swap(where_[i],where_[j]);
+    downs_[where_[i]]=i;
+    ups_[where_[j]]=j;
+  }
+
+  //sets the current state, initializing the look-up tables
+  void SetState(const std::vector<int> & state){
+    state_=state;
+    config_.Set(state_);
+    wf_.InitLt(state_);
+    InitSiteLists();
+  }
+
+  inline const std::vector<int> & State()const{
+    return state_;
+  }
+
+  //logarithm of the wave-function on the current state
+  inline std::complex<double> LogVal()const{
+    return wf_.LogValLt(state_);
   }
 
   void ResetAv(){
@@ -173,21 +312,29 @@ public:
 
   void Move(int nflips){
 
+    profile_.Count(Profile::Proposals);
+
     //Picking "nflips" random spins to be flipped
     if(RandSpin(flips_,nflips)){
 
       //Computing acceptance probability
+      std::uint64_t t=profile_.Start();
       double acceptance=std::norm(wf_.PoP(state_,flips_));
+      profile_.Stop(Profile::PoP,t);
 
       //Metropolis-Hastings test
       if(acceptance>Uniform()){
 
         //Updating look-up tables in the wave-function
+        t=profile_.Start();
         wf_.UpdateLt(state_,flips_);
+        profile_.Stop(Profile::UpdateLt,t);
+        profile_.Count(Profile::Accepts);
 
         //Moving to the new configuration
         for(const auto& flip : flips_){
           state_[flip]*=-1;
+          config_.Flip(flip);
         }
 
         accept_+=1;
@@ -197,23 +344,196 @@ public:
     nmoves_+=1;
   }
 
-  void SetFileStates(std::string filename){
+  //Generates the proposals and the Metropolis uniforms for nmoves moves
+  //for two spin flips the proposals are positions in the lists of
+  //up and down sites, so that every move exchanges two opposite spins
+  //(the lengths of the lists do not change during the sampling)
+  //local moves are marked by a negative second site, the first one
+  //being the index of the bond
+  void GenerateProposals(int nmoves,int nflips){
+    const int nsites=nmoves*nflips;
+    const bool local=(nflips==2 && localratio_>0);
+    const int nuniforms=nmoves+nsites+(local?nmoves:0);
+
+    uniforms_.resize(nuniforms);
+    sites_.resize(nsites);
+
+    rng_.Uniform(uniforms_.data(),nuniforms);
+
+    //u<1 guarantees that the products are rounded below the ranges
+    const double * u=uniforms_.data()+nmoves;
+    if(nflips==1){
+      for(int i=0;i<nsites;i++){
+        sites_[i]=int(u[i]*double(nspins_));
+      }
+    }
+    else{
+      const double nup=ups_.size();
+      const double ndown=downs_.size();
+      for(int i=0;i<nsites;i+=2){
+        sites_[i]=int(u[i]*nup);
+        sites_[i+1]=int(u[i+1]*ndown);
+      }
+    }
+
+    if(local){
+      const double * c=uniforms_.data()+nmoves+nsites;
+      const double nbonds=bonds_.size()/2;
+      for(int i=0;i<nmoves;i++){
+        if(c[i]<localratio_){
+          sites_[2*i]=int(u[2*i]*nbonds);
+          sites_[2*i+1]=-1;
+        }
+      }
+    }
+  }
+
+  //Metropolis move using pre-generated random numbers
+  //(see GenerateProposals), returns true if the move is accepted
+  inline bool Move(const int * flips,int nflips,double u){
+
+    nmoves_+=1;
+    profile_.Count(Profile::Proposals);
+
+    std::uint64_t t=profile_.Start();
+    double acceptance=std::norm(wf_.PoP(state_,flips,nflips));
+    profile_.Stop(Profile::PoP,t);
+
+    if(acceptance>u){
+      t=profile_.Start();
+      wf_.UpdateLt(state_,flips,nflips);
+      profile_.Stop(Profile::UpdateLt,t);
+      profile_.Count(Profile::Accepts);
+
+      for(int i=0;i<nflips;i++){
+        state_[flips[i]]*=-1;
+        config_.Flip(flips[i]);
+      }
+
+      accept_+=1;
+      return true;
+    }
+
+    return false;
+  }
+
+  //Performs nmoves Metropolis moves
+  void Moves(int nmoves,int nflips){
+    const std::uint64_t t=profile_.Start();
+    MovesImpl(nmoves,nflips);
+    profile_.Stop(Profile::Moves,t);
+  }
+
+  void MovesImpl(int nmoves,int nflips){
+    if(!batched_){
+      for(int i=0;i<nmoves;i++){
+        Move(nflips);
+      }
+      return;
+    }
+
+    GenerateProposals(nmoves,nflips);
+
+    if(nflips==1){
+      for(int i=0;i<nmoves;i++){
+        Move(sites_.data()+i,1,uniforms_[i]);
+      }
+      return;
+    }
+
+    //exchanges of an up and a down spin
+    int flips[2];
+    for(int i=0;i<nmoves;i++){
+      if(sites_[2*i+1]>=0){
+        flips[0]=ups_[sites_[2*i]];
+        flips[1]=downs_[sites_[2*i+1]];
+      }
+      else{
+        //local move along a bond, rejected if the spins are aligned
+        //the bond is chosen uniformly, hence the proposal is symmetric
+        const int * bond=bonds_.data()+2*sites_[2*i];
+        if(state_[bond[0]]==state_[bond[1]]){
+          nmoves_+=1;
+          profile_.Count(Profile::Proposals);
+          continue;
+        }
+        flips[0]=(state_[bond[0]]>0)?bond[0]:bond[1];
+        flips[1]=(state_[bond[0]]>0)?bond[1]:bond[0];
+      }
+      if(Move(flips,2,uniforms_[i])){
+        ExchangeSites(flips[0],flips[1]);
+      }
+    }
+  }
+
+  //sampled configurations are written in text or bit-packed binary format
+  //(see statesfile.cc)
+  //the output files are opened when the sweeps start (see OpenOutputFiles)
+  //or, when resuming from a checkpoint, truncated to their length at the
+  //checkpoint (see LoadCheckpoint)
+  void SetFileStates(std::string filename,bool binary=false){
     writestates_=true;
-    filestates_.open(filename.c_str());
-    if(!filestates_.is_open()){
-      std::cerr<<"# Error : Cannot open file "<<filename<<" for writing"<<std::endl;
+    filestatesname_=filename;
+    binarystates_=binary;
+    if(verbose_){
+      std::cout<<"# Saving sampled configuration to file "<<filename;
+      std::cout<<(binary?" (binary format)":"")<<std::endl;
+    }
+  }
+
+  //the measured local energies (real and imaginary part) are written
+  //on the given file, one measurement per row
+  void SetFileEnergies(std::string filename){
+    writeenergies_=true;
+    fileenergiesname_=filename;
+    if(verbose_){
+      std::cout<<"# Saving measured energies to file "<<filename<<std::endl;
+    }
+  }
+
+  //opens the output files not yet opened, erasing their content
+  void OpenOutputFiles(){
+    if(writestates_ && !filestates_.IsOpen()){
+      filestates_.Open(filestatesname_,nspins_,binarystates_);
+    }
+    if(writeenergies_ && !fileenergies_.is_open()){
+      OpenFileEnergies(std::ios::out|std::ios::trunc);
+    }
+  }
+
+  void OpenFileEnergies(std::ios::openmode mode){
+    fileenergies_.open(fileenergiesname_.c_str(),mode);
+    fileenergies_.seekp(0,std::ios::end);
+    if(!fileenergies_.is_open() || !fileenergies_.good()){
+      std::cerr<<"# Error : Cannot open file "<<fileenergiesname_<<" for writing"<<std::endl;
       std::abort();
     }
-    else{
-      std::cout<<"# Saving sampled configuration to file "<<filename<<std::endl;
+    fileenergies_<<std::setprecision(17);
+  }
+
+  //reopens the output files written up to a checkpoint, discarding what
+  //was written after it (negative offsets: files not written then)
+  void ResumeOutputFiles(std::int64_t statesoffset,bool binarystates,std::int64_t energiesoffset,CheckpointReader & in){
+    if(writestates_ && statesoffset>=0){
+      if(binarystates!=binarystates_){
+        in.Fail("the file of sampled configurations was written in a different format");
+      }
+      filestates_.Resume(filestatesname_,nspins_,binarystates_,statesoffset);
+    }
+    if(writeenergies_ && energiesoffset>=0){
+      if(!TruncateFile(fileenergiesname_,energiesoffset)){
+        in.Fail("the file of energies is missing or shorter than at the checkpoint");
+      }
+      OpenFileEnergies(std::ios::in|std::ios::out);
     }
   }
 
   void WriteState(){
-    for(const auto & spin_value : state_){
-      filestates_<<std::setw(2)<<spin_value<<" ";
-    }
-    filestates_<<std::endl;
+    const std::uint64_t t=profile_.Start();
+    const std::uint64_t bytes=filestates_.BytesWritten();
+    filestates_.Write(config_);
+    profile_.Count(Profile::BytesWritten,filestates_.BytesWritten()-bytes);
+    profile_.Stop(Profile::WriteState,t);
   }
 
   //Measuring the value of the local energy
@@ -225,13 +545,27 @@ public:
     //on the given state
     //i.e. all the state' such that <state'|H|state> = mel(state') \neq 0
     //state' is encoded as the sequence of spin flips to be performed on state
-    hamiltonian_.FindConn(state_,flipsh_,mel_);
+    std::uint64_t t=profile_.Start();
+    hamiltonian_.FindConn(config_,conn_);
+    profile_.Stop(Profile::FindConn,t);
+
+    //all the wave-function ratios are computed at once
+    t=profile_.Start();
+    wf_.PoP(state_,conn_,pops_);
+    profile_.Stop(Profile::ConnPoP,t);
+
+    profile_.Count(Profile::Measurements);
+    profile_.Count(Profile::ConnStates,conn_.Size());
 
-    for(int i=0;i<flipsh_.size();i++){
-      en+=wf_.PoP(state_,flipsh_[i])*mel_[i];
+    for(int i=0;i<conn_.Size();i++){
+      en+=pops_[i]*conn_.Mel(i);
     }
 
-    energy_.push_back(en);
+    binning_.Add(en.real());
+
+    if(writeenergies_){
+      fileenergies_<<en.real()<<" "<<en.imag()<<"\n";
+    }
   }
 
 
@@ -242,6 +576,27 @@ public:
   //nflipss is the number of random spin flips to be done, it is automatically set to 1 or 2 depending on the hamiltonian
   void Run(double nsweeps,double thermfactor=0.1,int sweepfactor=1,int nflipss=-1){
 
+    int nflips=CheckInput(nsweeps,thermfactor,nflipss);
+
+    if(verbose_){
+      std::cout<<"# Starting Monte Carlo sampling"<<std::endl;
+      std::cout<<"# Number of sweeps to be performed is "<<nsweeps<<std::endl;
+    }
+
+    const double done=Prepare(nsweeps*thermfactor,sweepfactor,nflips);
+
+    Sweep(nsweeps-done,sweepfactor,nflips);
+
+    OutputEnergy();
+
+    OutputProfile();
+
+  }
+
+  //checks the consistency of the input parameters of Run
+  //and returns the actual number of spin flips per move
+  int CheckInput(double nsweeps,double thermfactor,int nflipss)const{
+
     int nflips=nflipss;
 
     if(nflips==-1){
@@ -265,86 +620,347 @@ public:
       std::abort();
     }
 
-    std::cout<<"# Starting Monte Carlo sampling"<<std::endl;
-    std::cout<<"# Number of sweeps to be performed is "<<nsweeps<<std::endl;
+    return nflips;
+  }
 
-    InitRandomState();
+  //Initializes a random state and performs ntherm sweeps
+  //which are discarded for the initial equilibration
+  //if randomstart=false the sampling starts from the current state
+  //(e.g. set with SetState)
+  void Thermalize(double ntherm,int sweepfactor,int nflips,bool randomstart=true){
 
     flips_.resize(nflips);
 
-    //initializing look-up tables in the wave-function
-    wf_.InitLt(state_);
+    if(randomstart){
+      InitRandomState();
+
+      //initializing look-up tables in the wave-function
+      wf_.InitLt(state_);
+    }
 
     ResetAv();
+    profile_.SetStage(Profile::Thermalization);
 
-    std::cout<<"# Thermalization... ";
-    std::flush(std::cout);
+    if(verbose_){
+      std::cout<<"# Thermalization... ";
+      std::flush(std::cout);
+    }
 
     //thermalization
-    for(double n=0;n<nsweeps*thermfactor;n+=1){
-      for(int i=0;i<nspins_*sweepfactor;i++){
-        Move(nflips);
+    for(double n=0;n<ntherm;n+=1){
+      Moves(nspins_*sweepfactor,nflips);
+    }
+
+    if(verbose_){
+      std::cout<<" DONE "<<std::endl;
+      std::flush(std::cout);
+    }
+
+  }
+
+  //Brings the sampler to equilibrium before the sweeps: the state is
+  //restored from the checkpoint file if it exists, taken from the
+  //warm-start file if given, or thermalized with ntherm sweeps otherwise
+  //returns the number of sweeps already performed (restored checkpoint)
+  double Prepare(double ntherm,int sweepfactor,int nflips){
+
+    flips_.resize(nflips);
+
+    if(!checkpoint_.empty() && CheckpointReader::Exists(checkpoint_)){
+      LoadCheckpoint(checkpoint_,true);
+      resumed_=true;
+      if(verbose_){
+        std::cout<<"# Resuming from checkpoint "<<checkpoint_<<" after ";
+        std::cout<<binning_.Count()<<" sweeps"<<std::endl;
       }
+      return binning_.Count();
     }
-    std::cout<<" DONE "<<std::endl;
-    std::flush(std::cout);
 
-    ResetAv();
+    if(!warmstart_.empty()){
+      LoadCheckpoint(warmstart_,false);
+      if(verbose_){
+        std::cout<<"# Warm start from the configuration in "<<warmstart_<<", no thermalization"<<std::endl;
+      }
+      return 0;
+    }
 
-    std::cout<<"# Sweeping... ";
-    std::flush(std::cout);
+    Thermalize(ntherm,sweepfactor,nflips);
+    return 0;
+  }
 
-    //sequence of sweeps
-    for(double n=0;n<nsweeps;n+=1){
-      for(int i=0;i<nspins_*sweepfactor;i++){
-        Move(nflips);
+  //the state is saved on filename every interval sweeps and at the end,
+  //and if filename exists the sampling is resumed from it
+  void SetCheckpoint(std::string filename,double interval){
+    if(interval<1){
+      std::cerr<<"# Error : The checkpoint interval should be a positive number of sweeps"<<std::endl;
+      std::abort();
+    }
+    checkpoint_=filename;
+    checkpointinterval_=interval;
+  }
+
+  void SetWarmStart(std::string filename){
+    warmstart_=filename;
+  }
+
+  //saves configuration, look-up tables, random number generator,
+  //accumulated measurements and lengths of the output files, which are
+  //flushed so that they contain all the data up to the checkpoint
+  //the random number generator and the wave-function are identified,
+  //so that the sampling is not resumed with different ones
+  void SaveCheckpoint(std::string filename){
+    CheckpointWriter out;
+    out.Put(std::int64_t(nspins_));
+    out.Put(Rng::Name());
+    wf_.SaveId(out);
+    out.Put(config_.Words());
+    out.Put(ups_);
+    out.Put(downs_);
+    out.Put(accept_);
+    out.Put(nmoves_);
+    binning_.Save(out);
+    rng_.Save(out);
+    wf_.SaveLt(out);
+
+    std::int64_t statesoffset=-1;
+    std::int64_t energiesoffset=-1;
+    if(writestates_ && filestates_.IsOpen()){
+      filestates_.Flush();
+      statesoffset=filestates_.BytesWritten();
+    }
+    if(writeenergies_ && fileenergies_.is_open()){
+      fileenergies_.flush();
+      energiesoffset=fileenergies_.tellp();
+      if(!fileenergies_.good() || energiesoffset<0){
+        std::cerr<<"# Error : Cannot write to file "<<fileenergiesname_<<std::endl;
+        std::abort();
       }
+    }
+    out.Put(statesoffset);
+    out.Put(std::int64_t(binarystates_));
+    out.Put(energiesoffset);
+
+    out.Write(filename);
+  }
+
+  //restores the state saved by SaveCheckpoint
+  //if full=false only the configuration is used
+  void LoadCheckpoint(std::string filename,bool full){
+    CheckpointReader in(filename);
+
+    std::int64_t nspins;
+    in.Get(nspins);
+    if(nspins!=nspins_){
+      in.Fail("different number of spins");
+    }
+
+    //a warm start only needs a configuration of the same size
+    std::string rngname;
+    in.Get(rngname);
+    if(full && rngname!=Rng::Name()){
+      in.Fail("it was written with the random number generator "+rngname);
+    }
+    if(full){
+      wf_.CheckId(in);
+    }
+    else{
+      std::int64_t nv,nh,size;
+      std::uint64_t hash;
+      in.Get(nv);
+      in.Get(nh);
+      in.Get(size);
+      in.Get(hash);
+    }
+
+    config_.Resize(nspins_);
+    const std::size_t nwords=config_.NWords();
+    in.Get(config_.Words());
+    if(config_.NWords()!=int(nwords)){
+      in.Fail("invalid configuration");
+    }
+    config_.Get(state_);
+
+    if(!full){
+      wf_.InitLt(state_);
+      InitSiteLists();
+      return;
+    }
+
+    in.Get(ups_);
+    in.Get(downs_);
+    if(int(ups_.size()+downs_.size())!=nspins_){
+      in.Fail("invalid lists of sites");
+    }
+    where_.resize(nspins_);
+    for(std::size_t i=0;i<ups_.size();i++){
+      where_[ups_[i]]=i;
+    }
+    for(std::size_t i=0;i<downs_.size();i++){
+      where_[downs_[i]]=i;
+    }
+
+    in.Get(accept_);
+    in.Get(nmoves_);
+    binning_.Load(in);
+    rng_.Load(in);
+    wf_.LoadLt(in);
+
+    std::int64_t statesoffset,binarystates,energiesoffset;
+    in.Get(statesoffset);
+    in.Get(binarystates);
+    in.Get(energiesoffset);
+    ResumeOutputFiles(statesoffset,binarystates,energiesoffset,in);
+  }
+
+  //Performs nsweeps sweeps, measuring the energy after each of them
+  void Sweep(double nsweeps,int sweepfactor,int nflips){
+
+    //the statistics restored from a checkpoint are kept
+    if(!resumed_){
+      ResetAv();
+    }
+    resumed_=false;
+    profile_.SetStage(Profile::Sampling);
+
+    OpenOutputFiles();
+
+    if(verbose_){
+      std::cout<<"# Sweeping... ";
+      std::flush(std::cout);
+    }
+
+    //sequence of sweeps
+    double n=0;
+    for(;n<nsweeps;n+=1){
+      Moves(nspins_*sweepfactor,nflips);
       if(writestates_){
         WriteState();
       }
       MeasureEnergy();
+
+      if(!checkpoint_.empty() && std::fmod(binning_.Count(),checkpointinterval_)==0){
+        const std::uint64_t t=profile_.Start();
+        SaveCheckpoint(checkpoint_);
+        profile_.Stop(Profile::Checkpoint,t);
+      }
+
+      if(TargetReached()){
+        n+=1;
+        break;
+      }
     }
-    std::cout<<" DONE "<<std::endl;
-    std::flush(std::cout);
 
-    OutputEnergy();
+    if(!checkpoint_.empty()){
+      SaveCheckpoint(checkpoint_);
+    }
+
+    if(verbose_){
+      std::cout<<" DONE "<<std::endl;
+      if(n<nsweeps){
+        std::cout<<"# Target error reached after "<<n<<" sweeps"<<std::endl;
+      }
+      std::flush(std::cout);
+    }
 
   }
 
-  void OutputEnergy(){
-    int nblocks=50;
+  //Appends the measurements and statistics of another
+  //(independent) Markov chain to the ones of this sampler
+  void Merge(const Sampler & other){
+    binning_.Merge(other.binning_);
+    accept_+=other.accept_;
+    nmoves_+=other.nmoves_;
+    profile_.Merge(other.profile_);
+  }
 
-    int blocksize=std::floor(double(energy_.size())/double(nblocks));
+  //timers and counters, recorded only when compiled with -DNQS_PROFILE
+  inline const Profile & GetProfile()const{
+    return profile_;
+  }
 
-    double enmean=0;
-    double enmeansq=0;
+  //the profile is written on the given file at the end of the run,
+  //or on standard output if no file is set
+  void SetFileProfile(std::string filename){
+    fileprofile_=filename;
+  }
 
-    double enmean_unblocked=0;
-    double enmeansq_unblocked=0;
+  void OutputProfile()const{
+    if(Profile::Enabled){
+      profile_.Write(fileprofile_);
+    }
+  }
 
-    for(int i=0;i<nblocks;i++){
-      double eblock=0;
-      for(int j=i*blocksize;j<(i+1)*blocksize;j++){
-        eblock+=energy_[j].real();
-        assert(j<energy_.size());
+  void SetVerbose(bool verbose){
+    verbose_=verbose;
+  }
 
-        double delta=energy_[j].real()-enmean_unblocked;
-        enmean_unblocked+=delta/double(j+1);
-        double delta2=energy_[j].real()-enmean_unblocked;
-        enmeansq_unblocked+=delta*delta2;
-      }
-      eblock/=double(blocksize);
-      double delta=eblock-enmean;
-      enmean+=delta/double(i+1);
-      double delta2=eblock-enmean;
-      enmeansq+=delta*delta2;
+  //chooses between batched (default) and sequential proposals
+  void SetBatchedProposals(bool batched){
+    batched_=batched;
+    CheckLocalMoves();
+  }
+
+  //sets the fraction of exchange moves proposed between nearest neighbours
+  //along the bonds of the lattice, the others exchanging two random sites
+  //it is used only with batched proposals
+  void SetLocalMoves(double localratio){
+    if(localratio<0 || localratio>1){
+      std::cerr<<"# Error : The fraction of local moves should be a real number between 0 and 1"<<std::endl;
+      std::abort();
     }
+    localratio_=localratio;
 
-    enmeansq/=(double(nblocks-1));
-    enmeansq_unblocked/=(double((nblocks*blocksize-1)));
+    bonds_.clear();
+    for(const auto & bond : hamiltonian_.Bonds()){
+      bonds_.push_back(bond[0]);
+      bonds_.push_back(bond[1]);
+    }
+    if(localratio_>0 && bonds_.size()==0){
+      std::cerr<<"# Error : Local moves need a lattice with at least one bond"<<std::endl;
+      std::abort();
+    }
+    CheckLocalMoves();
+  }
+
+  //local moves are exchanges of two spins, made only by the batched
+  //proposals of Hamiltonians with two spin flips per move
+  void CheckLocalMoves()const{
+    if(localratio_>0 && (!batched_ || hamiltonian_.MinFlips()!=2)){
+      std::cerr<<"# Error : Local moves need batched proposals and a Hamiltonian with two spin flips per move"<<std::endl;
+      std::abort();
+    }
+  }
+
+  //sets the target statistical error on the energy per spin
+  //a non-positive value disables the check
+  void SetTargetError(double targeterror){
+    targeterror_=targeterror;
+  }
 
-    double estav=enmean/double(nspins_);
-    double esterror=std::sqrt(enmeansq/double(nblocks))/double(nspins_);
+  //true if the binning analysis has converged to an error
+  //smaller than the target one
+  inline bool TargetReached()const{
+    return targeterror_>0 && binning_.Converged() && binning_.Error()/double(nspins_)<=targeterror_;
+  }
+
+  //estimated energy per spin and its statistical error
+  inline double Energy()const{
+    return binning_.Mean()/double(nspins_);
+  }
+
+  inline double EnergyError()const{
+    return binning_.Error()/double(nspins_);
+  }
+
+  //results of the binning analysis (see binning.cc)
+  inline const Binning & Measurements()const{
+    return binning_;
+  }
+
+  void OutputEnergy(){
+
+    double estav=binning_.Mean()/double(nspins_);
+    double esterror=binning_.Error()/double(nspins_);
 
     int ndigits=std::log10(esterror);
     if(ndigits<0){
@@ -357,12 +973,30 @@ public:
     std::cout<<"# Estimated average energy per spin : "<<std::endl;
     std::cout<<"# "<<std::scientific<<std::setprecision(ndigits)<<estav;
     std::cout<<" +/-  "<<std::setprecision(0)<<esterror<<std::endl;
-    std::cout<<"# Error estimated with binning analysis consisting of ";
-    std::cout<<nblocks<<" bins "<<std::endl;
-    std::cout<<"# Block size is "<<blocksize<<std::endl;
+    std::cout<<"# Error estimated with logarithmic binning analysis of ";
+    std::cout<<std::setprecision(0)<<std::fixed<<binning_.Count()<<" measurements"<<std::endl;
+    std::cout<<"#   Block size   Number of blocks   Error per spin"<<std::endl;
+
+    for(int l=0;l<=binning_.MaxLevel();l++){
+      std::cout<<std::fixed<<std::setprecision(0);
+      std::cout<<"# "<<std::setw(12)<<std::ldexp(1.,l)<<" "<<std::setw(18)<<binning_.Count(l)<<"   ";
+      std::cout<<std::scientific<<std::setprecision(2)<<binning_.Error(l)/double(nspins_)<<std::endl;
+    }
+
+    const int lp=binning_.PlateauLevel();
+
+    if(binning_.Converged()){
+      std::cout<<std::fixed<<std::setprecision(0);
+      std::cout<<"# The error reaches a plateau at block size "<<std::ldexp(1.,lp)<<std::endl;
+    }
+    else{
+      std::cout<<"# Warning : the error did not reach a plateau, the error bar is not reliable."<<std::endl;
+      std::cout<<"# Increase the number of sweeps with the option --nsweeps=NSWEEPS"<<std::endl;
+    }
+
     std::cout<<"# Estimated autocorrelation time is ";
-    std::cout<<std::setprecision(0);
-    std::cout<<0.5*double(blocksize)*enmeansq/enmeansq_unblocked<<std::endl;
+    std::cout<<std::scientific<<std::setprecision(0);
+    std::cout<<binning_.Tau()<<std::endl;
   }
 
 };
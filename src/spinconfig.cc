@@ -0,0 +1,185 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include <vector>
+#include <cstdint>
+#include <iostream>
+
+//Bit-packed configuration of nspins spins
+//bit i is set when the z component of spin i is +1
+//Spins are packed in 64-bit words, spin i being bit i%64 of word i/64,
+//and unused bits of the last word are always zero
+class SpinConfig{
+
+  //number of spins
+  int nspins_;
+
+  //packed spins
+  std::vector<std::uint64_t> words_;
+
+public:
+
+  SpinConfig(int nspins=0){
+    Resize(nspins);
+  }
+
+  void Resize(int nspins){
+    nspins_=nspins;
+    words_.assign((nspins_+63)/64,0);
+  }
+
+  //packs a configuration given as a sequence of +/-1
+  void Set(const std::vector<int> & state){
+    Resize(state.size());
+    for(int i=0;i<nspins_;i++){
+      if(state[i]>0){
+        words_[i>>6]|=(std::uint64_t(1)<<(i&63));
+      }
+    }
+  }
+
+  //unpacks the configuration to a sequence of +/-1
+  void Get(std::vector<int> & state)const{
+    state.resize(nspins_);
+    for(int i=0;i<nspins_;i++){
+      state[i]=Spin(i);
+    }
+  }
+
+  //value (+1 or -1) of spin i
+  inline int Spin(int i)const{
+    return ((words_[i>>6]>>(i&63))&1)?1:-1;
+  }
+
+  inline void Flip(int i){
+    words_[i>>6]^=(std::uint64_t(1)<<(i&63));
+  }
+
+  inline int Nspins()const{
+    return nspins_;
+  }
+
+  inline int NWords()const{
+    return words_.size();
+  }
+
+  inline std::uint64_t Word(int k)const{
+    return words_[k];
+  }
+
+  inline const std::vector<std::uint64_t> & Words()const{
+    return words_;
+  }
+
+  inline std::vector<std::uint64_t> & Words(){
+    return words_;
+  }
+
+  //mask of the valid bits of word k
+  inline std::uint64_t Mask(int k)const{
+    const int rem=nspins_-64*k;
+    return (rem>=64)?(~std::uint64_t(0)):((std::uint64_t(1)<<rem)-1);
+  }
+
+  //64 consecutive spins on the ring of nspins sites, starting from pos:
+  //bit j of the result is spin (pos+j)%nspins
+  //for nspins<64 the ring is visited more than once
+  inline std::uint64_t Window(int pos)const{
+    std::uint64_t res=0;
+    int filled=0;
+
+    while(filled<64){
+      const int b=pos&63;
+      int avail=64-b;
+      if(avail>nspins_-pos){
+        avail=nspins_-pos;
+      }
+      if(avail>64-filled){
+        avail=64-filled;
+      }
+
+      std::uint64_t chunk=words_[pos>>6]>>b;
+      if(avail<64){
+        chunk&=(std::uint64_t(1)<<avail)-1;
+      }
+      res|=chunk<<filled;
+
+      filled+=avail;
+      pos+=avail;
+      if(pos==nspins_){
+        pos=0;
+      }
+    }
+    return res;
+  }
+
+  //word k of the configuration cyclically shifted by d sites:
+  //bit j of the result is spin (64*k+j+d)%nspins, unused bits are zero
+  inline std::uint64_t Shifted(int k,int d)const{
+    return Window((64*k+d)%nspins_)&Mask(k);
+  }
+
+  //number of spins up
+  inline int NUp()const{
+    int nup=0;
+    for(const auto & w : words_){
+      nup+=__builtin_popcountll(w);
+    }
+    return nup;
+  }
+
+  //total magnetization, sum of the spins
+  inline int Magnetization()const{
+    return 2*NUp()-nspins_;
+  }
+
+  //hash of the configuration (64-bit FNV-1a on the words)
+  inline std::uint64_t Hash()const{
+    std::uint64_t hash=14695981039346656037ULL;
+    for(const auto & w : words_){
+      hash^=w;
+      hash*=1099511628211ULL;
+    }
+    return hash;
+  }
+
+  inline bool operator==(const SpinConfig & other)const{
+    return nspins_==other.nspins_ && words_==other.words_;
+  }
+
+  inline bool operator!=(const SpinConfig & other)const{
+    return !(*this==other);
+  }
+
+};
+
+//calls f(i) for all the set bits i of the given word, in increasing order
+//offset is added to the bit indices
+template<class Function> inline void ForEachBit(std::uint64_t word,int offset,Function f){
+  while(word){
+    f(offset+__builtin_ctzll(word));
+    word&=word-1;
+  }
+}
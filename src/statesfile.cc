@@ -0,0 +1,316 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//Files of sampled configurations
+//
+//Two formats are supported:
+//
+//text   : on every row a configuration in the format ( 1 -1  1 ... -1),
+//         each spin taking 3 characters
+//binary : a 32-byte header followed by the bit-packed configurations
+//         (see spinconfig.cc), each one taking NWORDS 64-bit words
+//         in the byte order of the machine which wrote the file
+//
+//Header of the binary format
+struct StatesFileHeader{
+
+  //"NQSSTATE"
+  char magic[8];
+
+  //version of the format
+  std::uint32_t version;
+
+  //number of spins
+  std::uint32_t nspins;
+
+  //number of 64-bit words per configuration
+  std::uint32_t nwords;
+
+  char reserved[12];
+};
+
+static_assert(sizeof(StatesFileHeader)==32,"The header of binary states files must be 32 bytes long");
+
+const char StatesFileMagic[8]={'N','Q','S','S','T','A','T','E'};
+const std::uint32_t StatesFileVersion=1;
+
+//Truncates an existing file to the given size, e.g. to discard the data
+//written after a checkpoint
+//returns false if the file is missing or shorter than size
+inline bool TruncateFile(std::string filename,std::uint64_t size){
+  struct stat st;
+  if(stat(filename.c_str(),&st)!=0 || std::uint64_t(st.st_size)<size){
+    return false;
+  }
+  return truncate(filename.c_str(),size)==0;
+}
+
+//Buffered writer of sampled configurations
+//data are written to the file in chunks of bufsize_ bytes
+class StatesWriter{
+
+  std::ofstream fout_;
+
+  //option to use the binary format
+  bool binary_;
+
+  //number of spins
+  int nspins_;
+
+  //buffer of data not yet written to the file
+  std::vector<char> buffer_;
+  std::size_t used_;
+
+  //total number of bytes written
+  std::uint64_t nbytes_;
+
+  static const std::size_t bufsize_=1<<20;
+
+public:
+
+  StatesWriter():binary_(false),nspins_(0),used_(0),nbytes_(0){}
+
+  ~StatesWriter(){
+    Close();
+  }
+
+  void Open(std::string filename,int nspins,bool binary){
+    Close();
+
+    binary_=binary;
+    nspins_=nspins;
+    nbytes_=0;
+    used_=0;
+    buffer_.resize(bufsize_);
+
+    fout_.open(filename.c_str(),binary_?(std::ios::out|std::ios::binary):std::ios::out);
+
+    if(!fout_.is_open()){
+      std::cerr<<"# Error : Cannot open file "<<filename<<" for writing"<<std::endl;
+      std::abort();
+    }
+
+    if(binary_){
+      StatesFileHeader header;
+      std::memset(&header,0,sizeof(header));
+      std::memcpy(header.magic,StatesFileMagic,8);
+      header.version=StatesFileVersion;
+      header.nspins=nspins_;
+      header.nwords=(nspins_+63)/64;
+      Append(reinterpret_cast<const char *>(&header),sizeof(header));
+    }
+  }
+
+  //reopens a file whose first offset bytes were written by a previous run
+  //(e.g. up to a checkpoint), discarding the rest, so that new data are
+  //appended after them
+  void Resume(std::string filename,int nspins,bool binary,std::uint64_t offset){
+    Close();
+
+    binary_=binary;
+    nspins_=nspins;
+    nbytes_=offset;
+    used_=0;
+    buffer_.resize(bufsize_);
+
+    if(!TruncateFile(filename,offset)){
+      std::cerr<<"# Error : Cannot resume the file "<<filename<<" : missing or shorter than at the checkpoint"<<std::endl;
+      std::abort();
+    }
+
+    fout_.open(filename.c_str(),binary_?(std::ios::in|std::ios::out|std::ios::binary):(std::ios::in|std::ios::out));
+    fout_.seekp(0,std::ios::end);
+
+    if(!fout_.is_open() || !fout_.good()){
+      std::cerr<<"# Error : Cannot open file "<<filename<<" for writing"<<std::endl;
+      std::abort();
+    }
+  }
+
+  bool IsOpen()const{
+    return fout_.is_open();
+  }
+
+  void Write(const SpinConfig & config){
+    if(binary_){
+      Append(reinterpret_cast<const char *>(config.Words().data()),config.NWords()*sizeof(std::uint64_t));
+      return;
+    }
+
+    //each spin is written as " 1 " or "-1 "
+    const std::size_t rowsize=3*nspins_+1;
+    if(used_+rowsize>buffer_.size()){
+      Flush();
+      if(rowsize>buffer_.size()){
+        buffer_.resize(rowsize);
+      }
+    }
+
+    char * p=buffer_.data()+used_;
+    for(int i=0;i<nspins_;i++){
+      p[0]=(config.Spin(i)>0)?' ':'-';
+      p[1]='1';
+      p[2]=' ';
+      p+=3;
+    }
+    *p='\n';
+    used_+=rowsize;
+  }
+
+  //writes the buffered data to the file
+  void Flush(){
+    if(used_>0){
+      fout_.write(buffer_.data(),used_);
+      nbytes_+=used_;
+      used_=0;
+    }
+    fout_.flush();
+
+    if(!fout_.good()){
+      std::cerr<<"# Error : Cannot write sampled configurations"<<std::endl;
+      std::abort();
+    }
+  }
+
+  void Close(){
+    if(fout_.is_open()){
+      Flush();
+      fout_.close();
+    }
+  }
+
+  //total number of bytes written to the file so far
+  std::uint64_t BytesWritten()const{
+    return nbytes_+used_;
+  }
+
+private:
+
+  void Append(const char * data,std::size_t size){
+    if(used_+size>buffer_.size()){
+      Flush();
+      if(size>buffer_.size()){
+        fout_.write(data,size);
+        nbytes_+=size;
+        return;
+      }
+    }
+    std::memcpy(buffer_.data()+used_,data,size);
+    used_+=size;
+  }
+
+};
+
+//Reader of sampled configurations, in either format
+//the format is detected automatically
+class StatesReader{
+
+  std::ifstream fin_;
+
+  bool binary_;
+
+  int nspins_;
+
+  std::vector<std::uint64_t> words_;
+
+public:
+
+  StatesReader(std::string filename){
+    fin_.open(filename.c_str(),std::ios::in|std::ios::binary);
+
+    if(!fin_.is_open()){
+      std::cerr<<"# Error : Cannot open file "<<filename<<" for reading"<<std::endl;
+      std::abort();
+    }
+
+    StatesFileHeader header;
+    binary_=bool(fin_.read(reinterpret_cast<char *>(&header),sizeof(header)))
+            && std::memcmp(header.magic,StatesFileMagic,8)==0;
+
+    if(binary_){
+      if(header.version!=StatesFileVersion || header.nwords!=(header.nspins+63)/64){
+        std::cerr<<"# Error : File "<<filename<<" is not a valid states file"<<std::endl;
+        std::abort();
+      }
+      nspins_=header.nspins;
+      words_.resize(header.nwords);
+    }
+    else{
+      //number of spins from the first row of the text file
+      fin_.clear();
+      fin_.seekg(0);
+      std::string row;
+      std::getline(fin_,row);
+      nspins_=0;
+      for(const auto & c : row){
+        nspins_+=(c=='1');
+      }
+      fin_.seekg(0);
+    }
+  }
+
+  //true if the file is in binary format
+  bool Binary()const{
+    return binary_;
+  }
+
+  int Nspins()const{
+    return nspins_;
+  }
+
+  //reads the next configuration, returns false at the end of the file
+  bool Read(SpinConfig & config){
+    if(binary_){
+      if(!fin_.read(reinterpret_cast<char *>(words_.data()),words_.size()*sizeof(std::uint64_t))){
+        return false;
+      }
+      config.Resize(nspins_);
+      config.Words()=words_;
+      return true;
+    }
+
+    config.Resize(nspins_);
+    for(int i=0;i<nspins_;i++){
+      int spin;
+      if(!(fin_>>spin)){
+        return false;
+      }
+      if(spin>0){
+        config.Flip(i);
+      }
+    }
+    return true;
+  }
+
+};
@@ -0,0 +1,245 @@
+/*
+############################ COPYRIGHT NOTICE ##################################
+
+Code provided by G. Carleo and M. Troyer, written by G. Carleo, December 2016.
+
+Permission is granted for anyone to copy, use, modify, or distribute the
+accompanying programs and documents for any purpose, provided this copyright
+notice is retained and prominently displayed, along with a complete citation of
+the published version of the paper:
+ ______________________________________________________________________________
+| G. Carleo, and M. Troyer                                                     |
+| Solving the quantum many-body problem with artificial neural-networks        |
+|______________________________________________________________________________|
+
+The programs and documents are distributed without any warranty, express or
+implied.
+
+These programs were written for research purposes only, and are meant to
+demonstrate and reproduce the main results obtained in the paper.
+
+All use of these programs is entirely at the user's own risk.
+
+################################################################################
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <cassert>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+//Binary format for the parameters of the NQS wave-function
+//
+//The file consists of a 64-byte header followed by the payload.
+//All the arrays in the payload are stored as separate real and imaginary
+//planes of doubles (in the byte order of the machine which wrote the file),
+//each plane padded to a multiple of 8 doubles, in the order
+//
+//  Re(a) , Im(a)     : nvs doubles each, nvs=nv rounded up to a multiple of 8
+//  Re(b) , Im(b)     : nhs doubles each, nhs=nh rounded up to a multiple of 8
+//  Re(W) , Im(W)     : nv*nhs doubles each, W(v,h) being at v*nhs+h
+//
+//which is the same layout used by Nqs in memory, so that the weights can be
+//used directly from the memory-mapped file.
+//Every plane starts at a 64-byte boundary from the beginning of the file.
+//
+//Version 2 adds the flags of the header, written by nqs_convert, so that
+//the imaginary planes need not be read to know that they vanish.
+//Files of version 1 (without flags) are still accepted.
+
+struct WfBinaryHeader{
+
+  //"NQSWFBIN"
+  char magic[8];
+
+  //version of the format
+  std::uint32_t version;
+
+  //type of the stored parameters, see WfBinaryDtype
+  std::uint32_t dtype;
+
+  //number of visible and hidden units
+  std::int64_t nv;
+  std::int64_t nh;
+
+  //size of the payload in bytes
+  std::uint64_t payload;
+
+  //checksum of the payload
+  std::uint64_t checksum;
+
+  //properties of the parameters, see WfBinaryReal (zero in version 1)
+  std::uint64_t flags;
+
+  char reserved[8];
+};
+
+static_assert(sizeof(WfBinaryHeader)==64,"The header of binary wave-function files must be 64 bytes long");
+
+const char WfBinaryMagic[8]={'N','Q','S','W','F','B','I','N'};
+const std::uint32_t WfBinaryVersion=2;
+
+//complex numbers stored as real and imaginary planes of doubles
+const std::uint32_t WfBinaryDtype=1;
+
+//flag set when all the imaginary planes vanish
+const std::uint64_t WfBinaryReal=1;
+
+//number of doubles n rounded up to a whole number of cache lines
+constexpr std::int64_t WfBinaryPad(std::int64_t n){
+  return ((n+7)/8)*8;
+}
+
+//size of the payload for given numbers of visible and hidden units
+inline std::uint64_t WfBinaryPayload(std::int64_t nv,std::int64_t nh){
+  return sizeof(double)*2*(WfBinaryPad(nv)+WfBinaryPad(nh)+nv*WfBinaryPad(nh));
+}
+
+//true if all the imaginary planes of the payload vanish
+inline bool WfBinaryIsReal(const double * payload,std::int64_t nv,std::int64_t nh){
+  const std::int64_t nvs=WfBinaryPad(nv);
+  const std::int64_t nhs=WfBinaryPad(nh);
+  const double * planes[3]={payload+nvs,payload+2*nvs+nhs,payload+2*nvs+2*nhs+nv*nhs};
+  const std::int64_t sizes[3]={nvs,nhs,nv*nhs};
+
+  for(int k=0;k<3;k++){
+    for(std::int64_t i=0;i<sizes[k];i++){
+      if(planes[k][i]!=0){
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//64-bit FNV-1a hash, computed on 64-bit words
+inline std::uint64_t WfBinaryChecksum(const void * data,std::uint64_t bytes){
+  std::uint64_t hash=14695981039346656037ULL;
+  const unsigned char * p=static_cast<const unsigned char *>(data);
+
+  for(std::uint64_t i=0;i+8<=bytes;i+=8){
+    std::uint64_t w;
+    std::memcpy(&w,p+i,8);
+    hash^=w;
+    hash*=1099511628211ULL;
+  }
+  return hash;
+}
+
+//true if the given file starts with the magic string of the binary format
+inline bool IsWfBinary(std::string filename){
+  std::ifstream fin(filename.c_str(),std::ios::binary);
+  char magic[8];
+  if(!fin.read(magic,8)){
+    return false;
+  }
+  return std::memcmp(magic,WfBinaryMagic,8)==0;
+}
+
+//Maps a binary wave-function file in memory (read-only)
+//returns a pointer to the beginning of the file, which stays mapped
+//as long as copies of the returned pointer exist
+//only the header is validated, so that the pages of the payload are read
+//on demand, the checksum of the payload is verified if verify=true
+//(see WfBinaryVerify)
+inline std::shared_ptr<const char> WfBinaryMap(std::string filename,WfBinaryHeader & header,bool verify=false){
+
+  int fd=open(filename.c_str(),O_RDONLY);
+  if(fd<0){
+    std::cerr<<"# Error : Cannot load from file "<<filename<<" : file not found."<<std::endl;
+    std::abort();
+  }
+
+  struct stat st;
+  if(fstat(fd,&st)!=0 || std::uint64_t(st.st_size)<sizeof(WfBinaryHeader)){
+    std::cerr<<"# Trying to load from an invalid file."<<std::endl;
+    std::abort();
+  }
+
+  const std::size_t length=st.st_size;
+  void * addr=mmap(nullptr,length,PROT_READ,MAP_PRIVATE,fd,0);
+  close(fd);
+
+  if(addr==MAP_FAILED){
+    std::cerr<<"# Error : Cannot map file "<<filename<<" in memory"<<std::endl;
+    std::abort();
+  }
+
+  std::shared_ptr<const char> map(static_cast<const char *>(addr),[length](const char * p){
+    munmap(const_cast<char *>(p),length);
+  });
+
+  std::memcpy(&header,map.get(),sizeof(WfBinaryHeader));
+
+  if(std::memcmp(header.magic,WfBinaryMagic,8)!=0){
+    std::cerr<<"# Trying to load from an invalid file."<<std::endl;
+    std::abort();
+  }
+  if(header.version!=1 && header.version!=WfBinaryVersion){
+    std::cerr<<"# Error : Binary file "<<filename<<" has version "<<header.version;
+    std::cerr<<", only versions 1 and "<<WfBinaryVersion<<" are supported"<<std::endl;
+    std::abort();
+  }
+  if(header.dtype!=WfBinaryDtype){
+    std::cerr<<"# Error : Binary file "<<filename<<" contains an unsupported data type"<<std::endl;
+    std::abort();
+  }
+  if(header.nv<0 || header.nh<0 || header.payload!=WfBinaryPayload(header.nv,header.nh)
+     || length<sizeof(WfBinaryHeader)+header.payload){
+    std::cerr<<"# Trying to load from an invalid file."<<std::endl;
+    std::abort();
+  }
+  if(verify && WfBinaryChecksum(map.get()+sizeof(WfBinaryHeader),header.payload)!=header.checksum){
+    std::cerr<<"# Error : Binary file "<<filename<<" is corrupted (checksum mismatch)"<<std::endl;
+    std::abort();
+  }
+  if(verify && header.version>1 && bool(header.flags&WfBinaryReal)!=
+     WfBinaryIsReal(reinterpret_cast<const double *>(map.get()+sizeof(WfBinaryHeader)),header.nv,header.nh)){
+    std::cerr<<"# Error : Binary file "<<filename<<" is corrupted (wrong flags)"<<std::endl;
+    std::abort();
+  }
+
+  return map;
+}
+
+//Checks the integrity of a binary wave-function file, aborting if the
+//header is invalid or the checksum of the payload does not match
+inline void WfBinaryVerify(std::string filename){
+  WfBinaryHeader header;
+  WfBinaryMap(filename,header,true);
+}
+
+//Writes the header and the payload of a binary wave-function file
+//real tells whether all the imaginary planes vanish
+inline void WfBinaryWrite(std::string filename,std::int64_t nv,std::int64_t nh,const std::vector<double> & payload,bool real){
+
+  WfBinaryHeader header;
+  std::memset(&header,0,sizeof(header));
+  std::memcpy(header.magic,WfBinaryMagic,8);
+  header.version=WfBinaryVersion;
+  header.dtype=WfBinaryDtype;
+  header.nv=nv;
+  header.nh=nh;
+  header.payload=payload.size()*sizeof(double);
+  header.checksum=WfBinaryChecksum(payload.data(),header.payload);
+  header.flags=real?WfBinaryReal:0;
+
+  assert(header.payload==WfBinaryPayload(nv,nh));
+
+  std::ofstream fout(filename.c_str(),std::ios::binary);
+  fout.write(reinterpret_cast<const char *>(&header),sizeof(header));
+  fout.write(reinterpret_cast<const char *>(payload.data()),header.payload);
+
+  if(!fout.good()){
+    std::cerr<<"# Error : Cannot write to file "<<filename<<std::endl;
+    std::abort();
+  }
+}